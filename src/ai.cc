@@ -3,59 +3,125 @@
 //-----------------------------------------------------------------------------
 
 #include "ai.h"
-#include <algorithm>  // std::min()
+#include <algorithm>  // std::min(), std::max(), std::stable_sort()
+#include <climits>    // INT_MIN
+#include <thread>
 #include "board.h"
 
-const int Ai::kPartSearchingDepth = 10;
-const int Ai::kMaxStartingPositions = 6;
+const Ai::Settings Ai::kDefaultSettings = {10, 4, 5, 1, 0};
+
+Ai::Ai() : settings_(kDefaultSettings) {}
+
+Ai::Ai(const Settings &settings) : settings_(settings) {}
+
+void Ai::SearchCandidates(const Board &board_original,
+                          std::vector<Route> *routes, std::vector<int> *scores,
+                          long long *num_nodes) const {
+  Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(settings_.time_limit);
 
-Ai::Route Ai::GetBestRoute(const Board &board_original) const {
   // Determine orbs to be started to move.
-  std::vector<int> starts = DetermineStarts(board_original);
+  routes->clear();
+  scores->clear();
+  std::vector<int> starts = SelectStarts(board_original, deadline,
+                                         routes, scores, num_nodes);
+  int num_starts = static_cast<int>(starts.size());
+
+  // Search from each start.
+  std::vector<Route> start_routes(num_starts);
+  std::vector<int> start_scores(num_starts);
+  SearchFromStarts(board_original, starts, settings_.part_searching_depth,
+                   deadline, &start_routes, &start_scores, num_nodes);
+  routes->insert(routes->end(), start_routes.begin(), start_routes.end());
+  scores->insert(scores->end(), start_scores.begin(), start_scores.end());
+}
+
+Ai::Route Ai::Search(const Board &board_original,
+                     long long *num_nodes) const {
+  std::vector<Route> routes;
+  std::vector<int> scores;
+  SearchCandidates(board_original, &routes, &scores, num_nodes);
 
   // Search for the best route.
   Route best_route;
   int best_score = INT_MIN;
-  for (int i = 0; i < static_cast<int>(starts.size()); ++i) {
-    // Each start to be moved.
-    Board board = board_original;
-    Route route = {0};
-    route.begin_id = starts[i];
-    int score = INT_MIN;
-    int current_position = route.begin_id;
-
-    // Search for the route until the score isn't changed.
-    for (int phase = 1, num_moves = 0;; ++phase) {  // Each phase.
-      // Search for the route.
-      int prev_score = score;
-      score = SearchForRoute(
-          phase, num_moves, current_position,
-          0, score,
-          &board, &route);
-      if (score - prev_score == 0)
-        break;
-
-      // Move orbs along the route.
-      for (; num_moves < kPartSearchingDepth * phase; ++num_moves) {
-        board.MoveOrb(route.directions[num_moves], current_position);
-        current_position += route.directions[num_moves];
-      }
-    }
-
+  for (int i = 0; i < static_cast<int>(routes.size()); ++i) {
     // Update the best score.
-    if (best_score < score) {
-      best_score = score;
-      best_route = route;
+    if (best_score < scores[i]) {
+      best_score = scores[i];
+      best_route = routes[i];
     }
   }
 
   return best_route;
 }
 
-int Ai::SearchForRoute(int phase, int num_times, int current_id,
+void Ai::SearchFromStarts(const Board &board_original,
+                          const std::vector<int> &starts, int depth,
+                          const Clock::time_point &deadline,
+                          std::vector<Route> *routes, std::vector<int> *scores,
+                          long long *num_nodes) const {
+  // Share starts among threads.
+  int num_starts = static_cast<int>(starts.size());
+  std::vector<long long> num_start_nodes(num_starts, 0);
+  int num_threads = std::max(1, std::min(settings_.num_threads, num_starts));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.push_back(std::thread([&, t] {
+      for (int i = t; i < num_starts; i += num_threads) {
+        (*scores)[i] = SearchFromStart(board_original, starts[i], depth,
+                                       deadline, &(*routes)[i],
+                                       &num_start_nodes[i]);
+      }
+    }));
+  }
+  for (int t = 0; t < num_threads; ++t)
+    threads[t].join();
+
+  for (int i = 0; i < num_starts; ++i)
+    *num_nodes += num_start_nodes[i];
+}
+
+int Ai::SearchFromStart(const Board &board_original, int start, int depth,
+                        const Clock::time_point &deadline,
+                        Route *route, long long *num_nodes) const {
+  // Each start to be moved.
+  Board board = board_original;
+  route->begin_id = start;
+  route->directions.clear();
+  int score = INT_MIN;
+  int current_position = route->begin_id;
+
+  // Search for the route until the score isn't changed.
+  for (int phase = 1, num_moves = 0;; ++phase) {  // Each phase.
+    // Stop extending the route after the time limit.
+    if (1 < phase && 0 < settings_.time_limit && deadline <= Clock::now())
+      break;
+
+    // Search for the route.
+    int prev_score = score;
+    score = SearchForRoute(
+        depth, phase, num_moves, current_position,
+        0, score,
+        &board, route, num_nodes);
+    if (score - prev_score == 0)
+      break;
+
+    // Move orbs along the route.
+    for (; num_moves < depth * phase; ++num_moves) {
+      board.MoveOrb(route->directions[num_moves], current_position);
+      current_position += route->directions[num_moves];
+    }
+  }
+
+  return score;
+}
+
+int Ai::SearchForRoute(int depth, int phase, int num_times, int current_id,
                        int prev_direction, int best_evaluation,
-                       Board *board, Route *route) const {
-  if (kPartSearchingDepth * phase <= num_times)
+                       Board *board, Route *route,
+                       long long *num_nodes) const {
+  if (depth * phase <= num_times)
     return board->Evaluate();
 
   // Find the best direction each scenes.
@@ -69,12 +135,13 @@ int Ai::SearchForRoute(int phase, int num_times, int current_id,
 
     // Move an orb in the direction.
     board->MoveOrb(Board::k4Directions[i], current_id);
+    ++*num_nodes;
 
     // Search for a route.
     int evaluation = SearchForRoute(
-        phase, num_times + 1, dest,
+        depth, phase, num_times + 1, dest,
         -Board::k4Directions[i], best_evaluation,
-        board, route);
+        board, route, num_nodes);
 
     // Restore to previous board.
     board->MoveOrb(-Board::k4Directions[i], dest);
@@ -89,49 +156,46 @@ int Ai::SearchForRoute(int phase, int num_times, int current_id,
   return best_evaluation;
 }
 
-std::vector<int> Ai::DetermineStarts(const Board &board) const {
-  // Calculate the number of extra orbs each attribute
-  // to evaluate positions to be started to move after.
-  int num_orbs[Board::kNumAttributes] = {0};
+std::vector<int> Ai::SelectStarts(const Board &board,
+                                  const Clock::time_point &deadline,
+                                  std::vector<Route> *routes,
+                                  std::vector<int> *scores,
+                                  long long *num_nodes) const {
+  // Start from every position.
+  std::vector<int> starts;
   for (int y = 0; y < Board::kHeight; ++y) {
     for (int x = 0; x < Board::kWidth; ++x)
-      ++num_orbs[board.board(y, x)];
+      starts.push_back(board.GetId(y, x));
   }
-  int num_extra_orbs[Board::kNumAttributes];
-  for (int i = 0; i < Board::kNumAttributes; ++i)
-    num_extra_orbs[i] = num_orbs[i] % 3;
 
-  // Determine the best position to start move.
-  std::vector<int> starts;
-  std::vector<int> evaluations;
-  for (int y = 0; y < Board::kHeight; ++y) {
-    for (int x = 0; x < Board::kWidth; ++x) {
-      int id = board.GetId(y, x);
-      int attribute = board.board(id);
-
-      // Evaluate the current position.
-      int temp_num_extra_orbs = num_extra_orbs[attribute];
-      int distance_to_edges = std::min(y, (Board::kHeight - 1) - y) +
-                              std::min(x, (Board::kWidth - 1) - x);
-      int evaluation = 100 * temp_num_extra_orbs - distance_to_edges;
-
-      // Update deleting the id whose evaluation is minimum.
-      starts.push_back(id);
-      evaluations.push_back(evaluation);
-      if (starts.size() <= kMaxStartingPositions)
-        continue;
-      int deleted_id;
-      for (int i = 0, min_evaluation = INT_MAX;
-           i < kMaxStartingPositions; ++i) {
-        if (evaluations[i] < min_evaluation) {
-          min_evaluation = evaluations[i];
-          deleted_id = i;
-        }
-      }
-      starts.erase(starts.begin() + deleted_id);
-      evaluations.erase(evaluations.begin() + deleted_id);
-    }
+  // Search from the starts more shallowly than the full search and keep the
+  // better half, searching one move deeper at each round. Routes found on
+  // the way are also candidates for the best route.
+  int max_starts = std::max(1, settings_.max_starting_positions);
+  int max_depth = std::max(1, settings_.part_searching_depth - 1);
+  for (int depth = std::max(1, settings_.screening_depth);
+       max_starts < static_cast<int>(starts.size()); ++depth) {
+    int num_starts = static_cast<int>(starts.size());
+    std::vector<Route> start_routes(num_starts);
+    std::vector<int> start_scores(num_starts);
+    SearchFromStarts(board, starts, std::min(depth, max_depth), deadline,
+                     &start_routes, &start_scores, num_nodes);
+    routes->insert(routes->end(), start_routes.begin(), start_routes.end());
+    scores->insert(scores->end(), start_scores.begin(), start_scores.end());
+
+    // Sort the starts by their scores keeping the order of ties.
+    std::vector<int> order(num_starts);
+    for (int i = 0; i < num_starts; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return start_scores[b] < start_scores[a];
+    });
+    int num_kept = std::max(max_starts, (num_starts + 1) / 2);
+    std::vector<int> kept(num_kept);
+    for (int i = 0; i < num_kept; ++i)
+      kept[i] = starts[order[i]];
+    starts.swap(kept);
   }
 
   return starts;
-}
\ No newline at end of file
+}
@@ -5,33 +5,71 @@
 #ifndef PUZZLE_AND_DRAGOONS_AI_H_
 #define PUZZLE_AND_DRAGOONS_AI_H_
 
-#include <map>
+#include <chrono>
 #include <vector>
+#include "solver.h"
 
-class Board;
-
-class Ai {
+// Search for routes from a few starts by a phased depth-first search.
+// Starts are chosen by successive halving of shallower searches.
+class Ai : public Solver {
 public:
-  struct Route {
-    int size() const { return directions.size(); }
-
-    int begin_id;
-    std::map<int, int> directions;
+  struct Settings {
+    // Depth to simulate moving per part.
+    // This is main factor of accuracy and thinking time.
+    int part_searching_depth;
+    // The number of positions of orbs to start moving.
+    int max_starting_positions;
+    // Depth per part of the first shallower search from every position to
+    // choose starts. The better half is searched one move deeper at each
+    // round until "max_starting_positions" remain.
+    int screening_depth;
+    // The number of threads to search from starts in parallel.
+    int num_threads;
+    // Time in milliseconds after which routes are no longer extended,
+    // or 0 for no limit.
+    int time_limit;
   };
 
-  Route GetBestRoute(const Board &original_board) const;
+  static const Settings kDefaultSettings;
+
+  Ai();
+  explicit Ai(const Settings &settings);
+
+  // Search as GetBestRoute() does, and get every route found on the way with
+  // its evaluation in the order searched. The best route is the first one
+  // of the highest evaluation.
+  void SearchCandidates(const Board &original_board,
+                        std::vector<Route> *routes, std::vector<int> *scores,
+                        long long *num_nodes) const;
+
+protected:
+  Route Search(const Board &original_board,
+               long long *num_nodes) const override;
 
 private:
-  // Depth to simulate moving per part.
-  // This is main factor of accuracy and thinking time.
-  static const int kPartSearchingDepth;
-  // The number of positions of orbs to start moving.
-  static const int kMaxStartingPositions;
+  typedef std::chrono::steady_clock Clock;
 
-  int SearchForRoute(int phase, int num_times, int current_id,
+  // Search from "starts" in parallel.
+  void SearchFromStarts(const Board &original_board,
+                        const std::vector<int> &starts, int depth,
+                        const Clock::time_point &deadline,
+                        std::vector<Route> *routes, std::vector<int> *scores,
+                        long long *num_nodes) const;
+  int SearchFromStart(const Board &original_board, int start, int depth,
+                      const Clock::time_point &deadline,
+                      Route *route, long long *num_nodes) const;
+  int SearchForRoute(int depth, int phase, int num_times, int current_id,
                      int prev_direction, int best_evaluation,
-                     Board *original_board, Route *route) const;
-  std::vector<int> DetermineStarts(const Board &board) const;
+                     Board *original_board, Route *route,
+                     long long *num_nodes) const;
+  // Add routes searched from starts to "routes" and "scores".
+  std::vector<int> SelectStarts(const Board &board,
+                                const Clock::time_point &deadline,
+                                std::vector<Route> *routes,
+                                std::vector<int> *scores,
+                                long long *num_nodes) const;
+
+  Settings settings_;
 };
 
 #endif  // PUZZLE_AND_DRAGOONS_AI_H_
\ No newline at end of file
@@ -0,0 +1,168 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "animation.h"
+
+Animation::Animation() : time_(0), prev_time_(0) {}
+
+void Animation::Reset(const Board &board, int held_id) {
+  scenes_.clear();
+  time_ = prev_time_ = 0;
+  orbs_.clear();
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x) {
+      int id = board.GetId(y, x);
+      if (Board::kNone == board.board(id))
+        continue;
+      Orb orb = GetOrb(board, id);
+      orb.is_held = (id == held_id);
+      orbs_.push_back(orb);
+    }
+  }
+}
+
+void Animation::Move(const Board &board, int src, int direction,
+                     int duration) {
+  int dest = src + direction;
+  std::vector<Track> tracks;
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x) {
+      int id = board.GetId(y, x);
+      if (Board::kNone == board.board(id))
+        continue;
+      Track track;
+      track.from = track.to = GetOrb(board, id);
+
+      // Swap the touched orb and the next one.
+      if (id == src) {
+        track.from.is_held = track.to.is_held = true;
+        track.to.y = track.from.y + direction / Board::kArrayWidth;
+        track.to.x = track.from.x + direction % Board::kArrayWidth;
+      } else if (id == dest) {
+        track.to.y = track.from.y - direction / Board::kArrayWidth;
+        track.to.x = track.from.x - direction % Board::kArrayWidth;
+      }
+      tracks.push_back(track);
+    }
+  }
+  AddScene(tracks, duration, false);
+}
+
+void Animation::Vanish(const Board &board, const Board &vanished_board,
+                       int duration) {
+  std::vector<Track> tracks;
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x) {
+      int id = board.GetId(y, x);
+      if (Board::kNone == board.board(id))
+        continue;
+      Track track;
+      track.from = track.to = GetOrb(board, id);
+      if (Board::kNone == vanished_board.board(id))
+        track.to.alpha = 0.0;
+      tracks.push_back(track);
+    }
+  }
+  AddScene(tracks, duration, false);
+}
+
+void Animation::Drop(const Board &board, const Board &dropped_board,
+                     int duration) {
+  // Orbs keep their order in each column, and new orbs come from above.
+  std::vector<Track> tracks;
+  for (int x = 0; x < Board::kWidth; ++x) {
+    int src_y = Board::kHeight - 1;
+    for (int y = Board::kHeight - 1; 0 <= y; --y) {
+      while (0 <= src_y && Board::kNone == board.board(src_y, x))
+        --src_y;
+      Track track;
+      track.to = GetOrb(dropped_board, dropped_board.GetId(y, x));
+      track.from = track.to;
+      track.from.y = src_y;
+      tracks.push_back(track);
+      --src_y;
+    }
+  }
+  AddScene(tracks, duration, true);
+}
+
+void Animation::Wait(int duration) {
+  std::vector<Track> tracks;
+  std::vector<Orb> orbs = GetLastOrbs();
+  for (int i = 0; i < static_cast<int>(orbs.size()); ++i) {
+    Track track = {orbs[i], orbs[i]};
+    tracks.push_back(track);
+  }
+  AddScene(tracks, duration, false);
+}
+
+void Animation::Update(int duration) {
+  prev_time_ = time_;
+  time_ += duration;
+
+  // Finish scenes, carrying the rest of time over the next one.
+  while (!scenes_.empty() && scenes_.front().duration <= time_) {
+    time_ -= scenes_.front().duration;
+    prev_time_ = 0;
+    orbs_ = GetEndOrbs(scenes_.front());
+    scenes_.pop_front();
+  }
+  if (scenes_.empty())
+    time_ = prev_time_ = 0;
+}
+
+void Animation::GetOrbs(double ratio, std::vector<Orb> *orbs) const {
+  if (scenes_.empty()) {
+    *orbs = orbs_;
+    return;
+  }
+
+  // Interpolate orbs between the start and the end of the scene.
+  const Scene &scene = scenes_.front();
+  double time = prev_time_ + ratio * (time_ - prev_time_);
+  double t = (0 < scene.duration) ? time / scene.duration : 1.0;
+  if (scene.is_falling)
+    t *= t;
+  orbs->clear();
+  for (int i = 0; i < static_cast<int>(scene.tracks.size()); ++i) {
+    const Track &track = scene.tracks[i];
+    Orb orb = track.to;
+    orb.y = track.from.y + t * (track.to.y - track.from.y);
+    orb.x = track.from.x + t * (track.to.x - track.from.x);
+    orb.alpha = track.from.alpha + t * (track.to.alpha - track.from.alpha);
+    orbs->push_back(orb);
+  }
+}
+
+void Animation::AddScene(const std::vector<Track> &tracks, int duration,
+                         bool is_falling) {
+  Scene scene;
+  scene.tracks = tracks;
+  scene.duration = duration;
+  scene.is_falling = is_falling;
+  scenes_.push_back(scene);
+}
+
+std::vector<Animation::Orb> Animation::GetLastOrbs() const {
+  return scenes_.empty() ? orbs_ : GetEndOrbs(scenes_.back());
+}
+
+std::vector<Animation::Orb> Animation::GetEndOrbs(const Scene &scene) {
+  std::vector<Orb> orbs;
+  for (int i = 0; i < static_cast<int>(scene.tracks.size()); ++i) {
+    if (0.0 < scene.tracks[i].to.alpha)
+      orbs.push_back(scene.tracks[i].to);
+  }
+  return orbs;
+}
+
+Animation::Orb Animation::GetOrb(const Board &board, int id) {
+  Orb orb;
+  orb.attribute = board.board(id);
+  orb.y = id / Board::kArrayWidth - 1;
+  orb.x = id % Board::kArrayWidth - 1;
+  orb.alpha = 1.0;
+  orb.is_held = false;
+  return orb;
+}
@@ -0,0 +1,74 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_ANIMATION_H_
+#define PUZZLE_AND_DRAGOONS_ANIMATION_H_
+
+#include <deque>
+#include <vector>
+#include "board.h"
+
+// Orbs moving smoothly between boards. Scenes are queued in order and
+// played by advancing time at a fixed tick, independently of frames.
+class Animation {
+public:
+  struct Orb {
+    int attribute;
+    // The position in cells, which can be between cells or above the board.
+    double y, x;
+    // Opacity from 0 to 1.
+    double alpha;
+    // Whether the orb is touched.
+    bool is_held;
+  };
+
+  Animation();
+
+  // Show "board" without scenes. "held_id" is the id of the touched orb.
+  void Reset(const Board &board, int held_id = 0);
+  // Queue scenes. Each takes "duration" milliseconds.
+  // Move the orb at "src" of "board" in "direction".
+  void Move(const Board &board, int src, int direction, int duration);
+  // Fade out orbs of "board" which are empty in "vanished_board".
+  void Vanish(const Board &board, const Board &vanished_board, int duration);
+  // Drop orbs of "board" into empties and new orbs from above to make
+  // "dropped_board".
+  void Drop(const Board &board, const Board &dropped_board, int duration);
+  // Keep the last orbs.
+  void Wait(int duration);
+  // Advance by "duration" milliseconds.
+  void Update(int duration);
+  bool IsFinished() const { return scenes_.empty(); }
+  // Get orbs at "ratio" from 0 to 1 between the previous update and the
+  // last one.
+  void GetOrbs(double ratio, std::vector<Orb> *orbs) const;
+
+private:
+  struct Track {
+    Orb from, to;
+  };
+
+  struct Scene {
+    std::vector<Track> tracks;
+    int duration;
+    // Accelerate like falling instead of moving at a constant speed.
+    bool is_falling;
+  };
+
+  void AddScene(const std::vector<Track> &tracks, int duration,
+                bool is_falling);
+  // Orbs at the end of the queued scenes.
+  std::vector<Orb> GetLastOrbs() const;
+  static std::vector<Orb> GetEndOrbs(const Scene &scene);
+  static Orb GetOrb(const Board &board, int id);
+
+  std::deque<Scene> scenes_;
+  // Orbs after the finished scenes.
+  std::vector<Orb> orbs_;
+  // Time in the first scene at the last update and the previous one.
+  int time_;
+  int prev_time_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_ANIMATION_H_
@@ -5,12 +5,106 @@
 #include "board.h"
 #include <ctime>    // time()
 #include <cstdlib>  // srand(), rand()
-#include <queue>
 
 const int Board::kConnectionMinNum = 3;
 const int Board::kMaxCombos = kSize / kConnectionMinNum;
 const int Board::k4Directions[4] = {-kArrayWidth, -1, +1, +kArrayWidth};
 
+namespace {
+// A set of cells without sentinels. A bit "y * kWidth + x" means a cell.
+typedef unsigned int CellMask;
+static_assert(Board::kSize <= 32, "CellMask can't hold all cells.");
+
+const CellMask kAllCells = (Board::kSize < 32) ?
+    (1u << Board::kSize) - 1 : ~0u;
+const CellMask kFirstRow = (1u << Board::kWidth) - 1;
+
+CellMask GetFirstColumn() {
+  CellMask column = 0;
+  for (int y = 0; y < Board::kHeight; ++y)
+    column |= 1u << (y * Board::kWidth);
+  return column;
+}
+const CellMask kFirstColumn = GetFirstColumn();
+const CellMask kLastColumn = kFirstColumn << (Board::kWidth - 1);
+
+// Move each cell to the adjacent one. Cells moved outside are removed.
+CellMask ShiftToLeft(CellMask m) { return (m >> 1) & ~kLastColumn; }
+CellMask ShiftToRight(CellMask m) { return (m << 1) & ~kFirstColumn; }
+CellMask ShiftToUp(CellMask m) { return m >> Board::kWidth; }
+CellMask ShiftToDown(CellMask m) {
+  return (m << Board::kWidth) & kAllCells;
+}
+
+// Add cells adjacent to given ones in 4 directions.
+CellMask Expand(CellMask m) {
+  return m | ShiftToLeft(m) | ShiftToRight(m) | ShiftToUp(m) | ShiftToDown(m);
+}
+
+int CountCells(CellMask m) {
+#if defined(__GNUC__)
+  return __builtin_popcount(m);
+#else
+  int count = 0;
+  for (; m; m &= m - 1)
+    ++count;
+  return count;
+#endif
+}
+
+// "m" must not be empty.
+int FindFirstCell(CellMask m) {
+#if defined(__GNUC__)
+  return __builtin_ctz(m);
+#else
+  int cell = 0;
+  for (; !(m & 1u); m >>= 1)
+    ++cell;
+  return cell;
+#endif
+}
+
+int ClassifyShape(CellMask group, int size) {
+  for (int y = 0; y < Board::kHeight; ++y) {
+    CellMask row = kFirstRow << (y * Board::kWidth);
+    if ((group & row) == row)
+      return Board::kShapeRow;
+  }
+  if (size == 4)
+    return Board::kShapeFour;
+  if (size != 5)
+    return Board::kShapeNormal;
+
+  // Check whether there is a center of a cross.
+  if (group & ShiftToLeft(group) & ShiftToRight(group) &
+      ShiftToUp(group) & ShiftToDown(group)) {
+    return Board::kShapeCross;
+  }
+
+  // Move the group to the top-left corner and compare it with Ls.
+  while (!(group & kFirstRow))
+    group >>= Board::kWidth;
+  while (!(group & kFirstColumn))
+    group >>= 1;
+  const int w = Board::kWidth;
+  const CellMask kLs[4] = {
+    0x7u | (0x1u << w) | (0x1u << 2 * w),  // Top-left corner.
+    0x7u | (0x4u << w) | (0x4u << 2 * w),  // Top-right corner.
+    0x1u | (0x1u << w) | (0x7u << 2 * w),  // Bottom-left corner.
+    0x4u | (0x4u << w) | (0x7u << 2 * w),  // Bottom-right corner.
+  };
+  for (int i = 0; i < 4; ++i) {
+    if (group == kLs[i])
+      return Board::kShapeL;
+  }
+  return Board::kShapeFive;
+}
+}  // namespace
+
+bool Board::Group::Contains(int y, int x) const {
+  return (cells >> (y * kWidth + x)) & 1u;
+}
+
 void Board::Score::Add(const Score &score) {
   sum_orbs += score.sum_orbs;
   sum_combos += score.sum_combos;
@@ -18,12 +112,17 @@ void Board::Score::Add(const Score &score) {
     num_orbs[i] += score.num_orbs[i];
     num_combos[i] += score.num_combos[i];
   }
+  for (int i = 0; i < score.num_groups && num_groups < kMaxGroups; ++i)
+    groups[num_groups++] = score.groups[i];
 }
 
 void Board::Initialize() {
+  Initialize(static_cast<unsigned int>(time(NULL)));
+}
+
+void Board::Initialize(unsigned int seed) {
   // Set random seed.
-  // You should use a constant for debugging.
-  srand(static_cast<unsigned int>(time(NULL)));
+  srand(seed);
 
   // Initialize board randomly.
   for (int i = 0; i < kArraySize; ++i) {
@@ -48,81 +147,80 @@ void Board::Initialize() {
   } while (!Equals(prev_board));
 }
 
-Board::Score Board::VanishOrbs() {
-  Board next_board = *this;
+void Board::Load(const int orbs[kSize]) {
+  for (int i = 0; i < kArraySize; ++i)
+    set_board(i, kOutside);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x)
+      set_board(y, x, orbs[y * kWidth + x]);
+  }
+}
 
-  // Create a map for saving vanished orbs.
+Board::Score Board::VanishOrbs() {
+  // Create a map of orbs each attribute.
+  CellMask orbs[kNumAttributes] = {0};
   for (int y = 0; y < kHeight; ++y) {
     for (int x = 0; x < kWidth; ++x) {
-      int id = GetId(y, x);
-      int attribute = board(id);
-
-      // Check whether there are orbs having
-      // current orb's attribute on right and bottom side.
-      for (int i = 2; i < 4; ++i) {
-        // Count the number of connected orbs of
-        // same attribute each other.
-        int j = 1;
-        for (j = 1; board(id + k4Directions[i] * j) == attribute; ++j) {}
-
-        // Vanish connected orbs.
-        if (j < kConnectionMinNum)
-          continue;
-        for (--j; 0 <= j; --j) {
-          int dest = id + k4Directions[i] * j;
-          next_board.set_board(dest, kTemp);
-        }
-      }
+      int attribute = board(y, x);
+      if (0 <= attribute && attribute < kNumAttributes)
+        orbs[attribute] |= 1u << (y * kWidth + x);
     }
   }
 
+  // Create a map for saving vanished orbs.
+  CellMask vanished[kNumAttributes];
+  CellMask all_vanished = 0;
+  for (int i = 0; i < kNumAttributes; ++i) {
+    // Find the first orbs of 3 connected orbs in a row and a column.
+    CellMask m = orbs[i];
+    CellMask rows = m & ShiftToLeft(m) & ShiftToLeft(ShiftToLeft(m));
+    CellMask columns = m & ShiftToUp(m) & ShiftToUp(ShiftToUp(m));
+    vanished[i] = rows | (rows << 1) | (rows << 2) |
+                  columns | (columns << kWidth) | (columns << 2 * kWidth);
+    all_vanished |= vanished[i];
+  }
+
   Score information = {0};
-  std::queue<int> connected_orbs;
 
   // Get information about vanished orbs.
-  for (int y = 0; y < kHeight; ++y) {
-    for (int x = 0; x < kWidth; ++x) {
-      int id = GetId(y, x);
-      int attribute = board(id);
-      if (kTemp != next_board.board(id))
-        continue;
+  while (all_vanished) {
+    // If the current orb is going to be vanished,
+    // trace connected orbs of the same attribute
+    // to get information about them.
+    int first = FindFirstCell(all_vanished);
+    int attribute = board(first / kWidth, first % kWidth);
+    CellMask group = 1u << first;
+    CellMask prev_group;
+    do {
+      prev_group = group;
+      group = Expand(group) & vanished[attribute];
+    } while (group != prev_group);
+    all_vanished &= ~group;
+
+    int size = CountCells(group);
+    ++information.sum_combos;
+    ++information.num_combos[attribute];
+    information.sum_orbs += size;
+    information.num_orbs[attribute] += size;
+    if (information.num_groups < kMaxGroups) {
+      Group &record = information.groups[information.num_groups++];
+      record.attribute = attribute;
+      record.size = size;
+      record.shape = ClassifyShape(group, size);
+      record.cells = group;
+    }
 
-      // If the current orb is going to be vanished,
-      // trace connected orbs of the same attribute
-      // to get information about them.
-      ++information.sum_combos;
-      ++information.num_combos[attribute];
-
-      // Trace connected orbs of the same attribute.
-      connected_orbs.push(id);
-      next_board.set_board(id, kNone);
-      do {
-        int temp_id = connected_orbs.front();
-        connected_orbs.pop();
-        ++information.sum_orbs;
-        ++information.num_orbs[attribute];
-
-        // Search for 4 directions recursively.
-        for (int i = 0; i < 4; ++i) {
-          int dest = temp_id + k4Directions[i];
-          if (kTemp == next_board.board(dest) &&
-              attribute == board(dest)) {
-            connected_orbs.push(dest);
-            next_board.set_board(dest, kNone);
-          }
-        }
-      } while (!connected_orbs.empty());
+    // Vanish orbs.
+    for (; group; group &= group - 1) {
+      int cell = FindFirstCell(group);
+      set_board(cell / kWidth, cell % kWidth, kNone);
     }
   }
 
-  // Vanish orbs.
-  for (int i = 0; i < kArraySize; ++i)
-    set_board(i, next_board.board(i));
-
   return information;
 }
 
-void Board::DropOrbs() {
+void Board::DropOrbs(std::mt19937 *random) {
   // Drop orbs first if there are empties.
   for (int y = kHeight - 1; 0 <= y; --y) {
     for (int x = 0; x < kWidth; ++x) {
@@ -144,7 +242,7 @@ void Board::DropOrbs() {
   }
 
   // Add new orbs into the empties.
-  AddNewOrbs();
+  AddNewOrbs(random);
 }
 
 void Board::MoveOrb(int direction, int src) {
@@ -262,12 +360,12 @@ int Board::CountNumOrbsOnEdge() const {
   return num_orbs_on_edge;
 }
 
-void Board::AddNewOrbs() {
+void Board::AddNewOrbs(std::mt19937 *random) {
   for (int y = 0; y < kHeight; ++y) {
     for (int x = 0; x < kWidth; ++x) {
       int id = GetId(y, x);
       if (kNone == board(id))
-        set_board(id, rand() % kNumAttributes);
+        set_board(id, (random ? (*random)() : rand()) % kNumAttributes);
     }
   }
 }
@@ -5,10 +5,34 @@
 #ifndef PUZZLE_AND_DRAGOONS_BOARD_H_
 #define PUZZLE_AND_DRAGOONS_BOARD_H_
 
+#include <random>
+
 class Board {
 public:
   // The number of attributes of orbs.
   static const int kNumAttributes = 6;
+  // The number of groups recorded in a score.
+  static const int kMaxGroups = 20;
+
+  // Shapes of connected orbs vanished at once.
+  enum Shapes {
+    kShapeNormal,
+    kShapeFour,   // 4 orbs.
+    kShapeFive,   // 5 orbs forming neither an L nor a cross.
+    kShapeL,      // 5 orbs forming an L.
+    kShapeCross,  // 5 orbs forming a cross.
+    kShapeRow,    // Including a full row.
+  };
+
+  struct Group {
+    bool Contains(int y, int x) const;
+
+    int attribute;
+    int size;
+    int shape;
+    // Vanished cells. A bit "y * kWidth + x" is set for each cell.
+    unsigned int cells;
+  };
 
   struct Score {
     void Add(const Score &a);
@@ -17,6 +41,10 @@ public:
     int sum_combos;
     int num_orbs[kNumAttributes];
     int num_combos[kNumAttributes];
+    // Vanished groups in order of their first cells. Groups after the
+    // first "kMaxGroups" are counted in the sums but not recorded.
+    int num_groups;
+    Group groups[kMaxGroups];
   };
 
   enum OrbAttributes {
@@ -45,9 +73,14 @@ public:
   static const int k4Directions[4];
 
   void Initialize();
+  // Initialize with a constant seed for reproducing a board.
+  void Initialize(unsigned int seed);
+  // Place orbs given in order of rows.
+  void Load(const int orbs[kSize]);
   // Return information about vanished orbs.
   Score VanishOrbs();
-  void DropOrbs();
+  // New orbs come from "random", or from rand() if it is NULL.
+  void DropOrbs(std::mt19937 *random = NULL);
   void MoveOrb(int direction, int src);
   void Swap(int id_1, int id_2);
   bool Equals(const Board &target) const;
@@ -65,7 +98,7 @@ protected:
   int CountNumOrbsOnEdge() const;
 
 private:
-  void AddNewOrbs();
+  void AddNewOrbs(std::mt19937 *random);
   bool IsOrb(int id) const;
   bool IsEdge(int y, int x) const;
 
@@ -3,66 +3,299 @@
 //-----------------------------------------------------------------------------
 
 #include "game.h"
-#include "ai.h"
+#include <algorithm>  // std::min(), std::max()
+#include <chrono>
+#include <cstdlib>    // srand(), rand()
 
-void Game::Initialize() {
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// Duration in milliseconds of a tick, at which turns and animations are
+// advanced regardless of frames.
+const int kTickDuration = 10;
+// The maximum number of ticks to catch up at once after a stall.
+const int kMaxTicksPerFrame = 10;
+// Duration in milliseconds of animations.
+const int kMoveDuration = 20;
+const int kMoveWaitDuration = 200;
+const int kVanishDuration = 500;
+const int kDropDuration = 300;
+const int kResultDuration = 1500;
+// Interval in seconds to write statistics.
+const int kStatisticsInterval = 60;
+
+unsigned int GetMicroseconds(const Clock::time_point &begin) {
+  return static_cast<unsigned int>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now() - begin).count());
+}
+}  // namespace
+
+Game::Game()
+    : solver_(NULL), shows_hints_(false), waits_for_hint_(false),
+      state_(kStateThinking), is_moving_(false), current_position_(0),
+      max_combos_(0) {
+  score_ = Board::Score();
+}
+
+bool Game::Initialize() {
   board_.Initialize();
-  graphic_.Initialize();
+  return graphic_.Initialize();
 }
 
 void Game::Terminate() {
+  hinter_.Stop();
+  trace_writer_.Close();
+  statistics_.Close();
   graphic_.Terminate();
 }
 
-void Game::Play() {
-  bool is_moving = false;
+bool Game::OpenTrace(const char *path, const char *solver_name) {
+  return trace_writer_.Open(path, solver_name);
+}
+
+bool Game::OpenStatistics(const char *path) {
+  return statistics_.Open(path, kStatisticsInterval);
+}
+
+void Game::Play(bool shows_hints) {
+  Run(NULL, shows_hints);
+}
+
+void Game::SolveAuto(const Solver &solver) {
+  Run(&solver, false);
+}
+
+void Game::Run(const Solver *solver, bool shows_hints) {
+  solver_ = solver;
+  shows_hints_ = shows_hints;
+  if (shows_hints_)
+    hinter_.Start();
+  if (solver_)
+    StartThinking();
+  else
+    StartPlaying();
+
+  std::vector<Graphic::Event> events;
+  bool needs_display = true;
+  Clock::time_point next_tick = Clock::now();
+  const Clock::duration kTick = std::chrono::milliseconds(kTickDuration);
   while (true) {
-    // Move orbs following the mouse cursor.
-    graphic_.DisplayBoard(board_);
-    graphic_.MoveOrbs(&is_moving, &board_);
+    // Sleep until the next tick unless events come.
+    Clock::duration rest = next_tick - Clock::now();
+    int timeout = (rest <= Clock::duration::zero()) ? 0 : static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            rest + std::chrono::milliseconds(1) - Clock::duration(1)).count());
+    events.clear();
+    if (!graphic_.WaitEvents(timeout, &events))
+      break;
+    HandleEvents(events);
+    needs_display = needs_display || !events.empty() || waits_for_hint_;
 
-    // If the cursor move has stopped, display result.
-    if (is_moving)
+    // Advance at the fixed tick, skipping ticks after a long stall. Orbs
+    // stay still unless they are animated or the state changes.
+    int num_ticks = 0;
+    for (; next_tick <= Clock::now(); ++num_ticks) {
+      if (kMaxTicksPerFrame <= num_ticks) {
+        next_tick = Clock::now() + kTick;
+        break;
+      }
+      int prev_state = state_;
+      needs_display = needs_display || state_ == kStateAnimating;
+      Update();
+      needs_display = needs_display || state_ != prev_state;
+      next_tick += kTick;
+    }
+    if (!needs_display)
       continue;
-    int max_combos = board_.CalculateMaxCombos();
-    Board::Score score = VanishOrbs();
-    graphic_.DisplayResult(score, max_combos);
-    graphic_.WaitClick();
+
+    // Display orbs between the last two ticks.
+    double ratio = 1.0 - std::chrono::duration<double>(
+        next_tick - Clock::now()) / kTick;
+    Display(std::min(1.0, std::max(0.0, ratio)));
+    needs_display = false;
   }
+
+  // Don't leave the ai searching.
+  if (route_.valid())
+    route_.wait();
 }
 
-void Game::SolveAuto() {
-  Ai ai;
-  while (true) {
-    // Calculate a route for solving a puzzle.
-    graphic_.DisplayBoard(board_);
-    Ai::Route route = ai.GetBestRoute(board_);
-
-    // Move orbs along the route.
-    int current_position = route.begin_id;
-    for (int i = 0; i < route.size(); ++i) {
-      // Check whether this is the end of the route.
-      int direction = route.directions[i];
-      if (0 == direction)
-        break;
+void Game::HandleEvents(const std::vector<Graphic::Event> &events) {
+  for (int i = 0; i < static_cast<int>(events.size()); ++i) {
+    const Graphic::Event &event = events[i];
+
+    // Start the next turn by a click after the result.
+    if (state_ == kStateResult && !solver_) {
+      if (event.type == Graphic::kEventRelease)
+        StartPlaying();
+      continue;
+    }
+    if (state_ != kStatePlaying)
+      continue;
+
+    // Move orbs following the mouse cursor.
+    int prev_position = current_position_;
+    if (event.type == Graphic::kEventPress && event.position != 0) {
+      is_moving_ = true;
+      current_position_ = event.position;
+    } else if (event.type == Graphic::kEventMotion && is_moving_ &&
+               event.position != 0 && event.position != current_position_) {
+      board_.Swap(event.position, current_position_);
+      current_position_ = event.position;
+    } else if (event.type == Graphic::kEventRelease && is_moving_) {
+      is_moving_ = false;
+      current_position_ = 0;
+    } else {
+      continue;
+    }
+    animation_.Reset(board_, current_position_);
+    if (shows_hints_)
+      hinter_.Update(board_, current_position_);
+
+    // Record the route.
+    if (prev_position == 0) {
+      turn_.begin_id = current_position_;
+    } else if (current_position_ != 0 && current_position_ != prev_position) {
+      turn_.directions.push_back(current_position_ - prev_position);
+    }
 
-      // Move orbs.
-      board_.MoveOrb(direction, current_position);
-      current_position += direction;
-      graphic_.DisplayBoard(board_, current_position);
-      graphic_.Sleep(20);
+    // If the cursor move has stopped, vanish orbs.
+    if (!is_moving_) {
+      turn_.think_time = GetMicroseconds(begin_time_);
+      statistics_.Record(Statistics::kThinkTime, turn_.think_time);
+      animation_begin_time_ = Clock::now();
+      FinishTurn();
     }
-    graphic_.Sleep(200);
+  }
+}
 
-    // Vanish connecting orbs and display result.
-    int max_combos = board_.CalculateMaxCombos();
-    Board::Score score = VanishOrbs();
-    graphic_.DisplayResult(score, max_combos);
-    graphic_.Sleep(1500);
+void Game::Update() {
+  animation_.Update(kTickDuration);
+  switch (state_) {
+  case kStateThinking:
+    if (route_.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready) {
+      MoveAlongRoute(route_.get());
+      FinishTurn();
+    }
+    break;
+  case kStateAnimating:
+    if (animation_.IsFinished()) {
+      RecordStatistics(turn_, GetMicroseconds(animation_begin_time_),
+                       max_combos_ - score_.sum_combos);
+      state_ = kStateResult;
+      if (solver_)
+        animation_.Wait(kResultDuration);
+    }
+    break;
+  case kStateResult:
+    // The player starts the next turn by a click.
+    if (solver_ && animation_.IsFinished())
+      StartThinking();
+    break;
+  default:
+    break;
   }
 }
 
-Board::Score Game::VanishOrbs() {
+void Game::Display(double ratio) {
+  std::vector<Animation::Orb> orbs;
+  animation_.GetOrbs(ratio, &orbs);
+  Solver::Route hint;
+  bool has_hint = state_ == kStatePlaying && shows_hints_ &&
+                  hinter_.GetHint(&hint);
+  waits_for_hint_ = state_ == kStatePlaying && shows_hints_ && !has_hint;
+  graphic_.DrawBoard(orbs, has_hint ? &hint : NULL);
+  if (state_ == kStateResult)
+    graphic_.DrawResult(score_, max_combos_);
+  graphic_.Display();
+}
+
+void Game::StartTurn(int mode, trace::Turn *turn) const {
+  turn->mode = mode;
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x)
+      turn->orbs[y * Board::kWidth + x] = board_.board(y, x);
+  }
+  turn->seed = 0;
+  turn->begin_id = 0;
+  turn->directions.clear();
+  turn->waves.clear();
+  turn->think_time = 0;
+}
+
+void Game::StartThinking() {
+  StartTurn(trace::kModeAi, &turn_);
+  animation_.Reset(board_);
+  state_ = kStateThinking;
+
+  // Calculate a route for solving a puzzle in a background thread to keep
+  // displaying. "turn_.think_time" is read after the route is got, and the
+  // time is recorded where it is measured.
+  const Solver *solver = solver_;
+  Board board = board_;
+  unsigned int *think_time = &turn_.think_time;
+  Statistics *statistics = &statistics_;
+  route_ = std::async(std::launch::async,
+                      [solver, board, think_time, statistics] {
+    Clock::time_point begin_time = Clock::now();
+    Solver::Route route = solver->GetBestRoute(board);
+    *think_time = GetMicroseconds(begin_time);
+    statistics->Record(Statistics::kThinkTime, *think_time);
+    return route;
+  });
+}
+
+void Game::StartPlaying() {
+  StartTurn(trace::kModePlayer, &turn_);
+  animation_.Reset(board_);
+  if (shows_hints_)
+    hinter_.Update(board_, 0);
+  state_ = kStatePlaying;
+  is_moving_ = false;
+  current_position_ = 0;
+  begin_time_ = Clock::now();
+}
+
+void Game::MoveAlongRoute(const Solver::Route &route) {
+  turn_.begin_id = route.begin_id;
+  animation_begin_time_ = Clock::now();
+
+  // Move orbs along the route.
+  int current_position = route.begin_id;
+  for (int i = 0; i < route.size(); ++i) {
+    // Check whether this is the end of the route.
+    std::map<int, int>::const_iterator it = route.directions.find(i);
+    if (it == route.directions.end() || it->second == 0)
+      break;
+
+    // Move orbs.
+    int direction = it->second;
+    animation_.Move(board_, current_position, direction, kMoveDuration);
+    board_.MoveOrb(direction, current_position);
+    current_position += direction;
+    turn_.directions.push_back(direction);
+  }
+  animation_.Wait(kMoveWaitDuration);
+}
+
+void Game::FinishTurn() {
+  // Vanish connecting orbs and display result.
+  SetSeed(&turn_);
+  max_combos_ = board_.CalculateMaxCombos();
+  score_ = VanishOrbs(&turn_.waves);
+  trace_writer_.Write(turn_);
+  state_ = kStateAnimating;
+}
+
+void Game::SetSeed(trace::Turn *turn) const {
+  // Derive the seed from the current sequence to keep it reproducible.
+  turn->seed = static_cast<unsigned int>(rand());
+  srand(turn->seed);
+}
+
+Board::Score Game::VanishOrbs(std::vector<trace::Wave> *waves) {
   Board::Score score = {0};
 
   // Continue to vanish and drop orbs untill nothing is changed.
@@ -70,15 +303,29 @@ Board::Score Game::VanishOrbs() {
   do {
     // Vanish orbs.
     prev_board = board_;
-    score.Add(board_.VanishOrbs());
-    graphic_.DisplayBoard(board_);
-    graphic_.Sleep(500);
+    Board::Score wave_score = board_.VanishOrbs();
+    score.Add(wave_score);
+    if (0 < wave_score.sum_combos) {
+      trace::Wave wave = {wave_score.sum_orbs, wave_score.sum_combos};
+      waves->push_back(wave);
+    }
+    animation_.Vanish(prev_board, board_, kVanishDuration);
 
     // Drop orbs.
+    Board vanished_board = board_;
     board_.DropOrbs();
-    graphic_.DisplayBoard(board_);
-    graphic_.Sleep(300);
+    animation_.Drop(vanished_board, board_, kDropDuration);
   } while (!board_.Equals(prev_board));
 
   return score;
 }
+
+void Game::RecordStatistics(const trace::Turn &turn,
+                            unsigned int animation_time, int missed_combos) {
+  statistics_.Record(Statistics::kAnimationTime, animation_time);
+  statistics_.Record(Statistics::kCascadeDepth,
+                     static_cast<long long>(turn.waves.size()));
+  // More combos than the estimate can be made by falling orbs.
+  statistics_.Record(Statistics::kMissedCombos,
+                     (0 < missed_combos) ? missed_combos : 0);
+}
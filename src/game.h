@@ -5,23 +5,87 @@
 #ifndef PUZZLE_AND_DRAGOONS_GAME_H_
 #define PUZZLE_AND_DRAGOONS_GAME_H_
 
+#include <chrono>
+#include <future>
+#include <vector>
+#include "animation.h"
 #include "board.h"
 #include "graphic.h"
+#include "hinter.h"
+#include "solver.h"
+#include "statistics.h"
+#include "trace.h"
 
 class Game {
 public:
-  void Initialize();
+  Game();
+
+  // Return false if the window can't be opened.
+  bool Initialize();
   void Terminate();
-  // A player can play the puzzle.
-  void Play();
-  // The ai continues to solve puzzle automatically.
-  void SolveAuto();
+  // Record each turn into a file with the name of the ai.
+  bool OpenTrace(const char *path, const char *solver_name);
+  // Write percentiles of turn statistics into a file periodically.
+  bool OpenStatistics(const char *path);
+  // A player can play the puzzle, with hints while moving an orb if
+  // "shows_hints" is true. Return when the window is closed.
+  void Play(bool shows_hints);
+  // The ai continues to solve puzzle automatically until the window is
+  // closed.
+  void SolveAuto(const Solver &solver);
 
 private:
-  Board::Score VanishOrbs();
+  typedef std::chrono::steady_clock Clock;
+
+  enum States {
+    kStateThinking,   // The ai is searching for a route.
+    kStatePlaying,    // The player is moving orbs.
+    kStateAnimating,  // Orbs are moving, vanishing and dropping.
+    kStateResult,     // The result is displayed.
+  };
+
+  // Run frames until the window is closed. "solver" is NULL for a player.
+  void Run(const Solver *solver, bool shows_hints);
+  void HandleEvents(const std::vector<Graphic::Event> &events);
+  // Advance the turn by a tick.
+  void Update();
+  // Display orbs at "ratio" from 0 to 1 between the last two ticks.
+  void Display(double ratio);
+  void StartTurn(int mode, trace::Turn *turn) const;
+  void StartThinking();
+  void StartPlaying();
+  void MoveAlongRoute(const Solver::Route &route);
+  // Vanish orbs after moving, and animate it.
+  void FinishTurn();
+  // Save the seed into "turn" and set it.
+  void SetSeed(trace::Turn *turn) const;
+  Board::Score VanishOrbs(std::vector<trace::Wave> *waves);
+  void RecordStatistics(const trace::Turn &turn, unsigned int animation_time,
+                        int missed_combos);
 
   Board board_;
   Graphic graphic_;
+  trace::Writer trace_writer_;
+  Hinter hinter_;
+  Statistics statistics_;
+  Animation animation_;
+
+  const Solver *solver_;
+  bool shows_hints_;
+  // Whether the hint for the displayed board hasn't been searched yet.
+  bool waits_for_hint_;
+  int state_;
+  trace::Turn turn_;
+  Clock::time_point begin_time_;
+  Clock::time_point animation_begin_time_;
+  // The route searched in a background thread.
+  std::future<Solver::Route> route_;
+  // Input of the player.
+  bool is_moving_;
+  int current_position_;
+  // The result of the turn.
+  Board::Score score_;
+  int max_combos_;
 };
 
-#endif  // PUZZLE_AND_DRAGOONS_GAME_H_
\ No newline at end of file
+#endif  // PUZZLE_AND_DRAGOONS_GAME_H_
@@ -3,23 +3,25 @@
 //-----------------------------------------------------------------------------
 
 #include "graphic.h"
+#include <algorithm>  // std::min()
 #include <cstdio>
+#include <cstdlib>    // abs()
 
 const int Graphic::kImageSizeOrb = 90;
 const int Graphic::kWidthWindow = Board::kWidth * kImageSizeOrb;
 const int Graphic::kHeightWindow = Board::kHeight * kImageSizeOrb;
 
-void Graphic::Initialize() {
+bool Graphic::Initialize() {
   // Initialize the SDL.
   if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
     fprintf(stderr, "ERROR: %s\n", SDL_GetError());
-    exit(-1);
+    return false;
   }
 
   // Initialize a font service.
   if (TTF_Init() < 0) {
     fprintf(stderr, "ERROR: %s\n", TTF_GetError());
-    exit(-1);
+    return false;
   }
 
   window = SDL_CreateWindow(
@@ -28,12 +30,12 @@ void Graphic::Initialize() {
       kWidthWindow, kHeightWindow, 0);
   if (!window) {
     fprintf(stderr, "ERROR: %s\n", SDL_GetError());
-    exit(-1);
+    return false;
   }
   video_surface = SDL_GetWindowSurface(window);
   if (!video_surface) {
     fprintf(stderr, "ERROR: %s\n", SDL_GetError());
-    exit(-1);
+    return false;
   }
 
   // Load images.
@@ -44,15 +46,16 @@ void Graphic::Initialize() {
   if (!image_orb || !image_result || !image_orb_small ||
       !image_overlayed_orb_small) {
     fprintf(stderr, "ERROR: %s\n", IMG_GetError());
-    exit(-1);
+    return false;
   }
 
   // Load a font.
   font = TTF_OpenFont("src/resources/font.ttf", 40);
   if (!font) {
     fprintf(stderr, "ERROR: %s\n", TTF_GetError());
-    exit(-1);
+    return false;
   }
+  return true;
 }
 
 void Graphic::Terminate() {
@@ -69,33 +72,32 @@ void Graphic::Terminate() {
   SDL_Quit();
 }
 
-void Graphic::DisplayBoard(const Board &board, int current_position) {
+void Graphic::DrawBoard(const std::vector<Animation::Orb> &orbs,
+                        const Solver::Route *hint) {
   ClearScreen();
 
   // Draw orbs.
-  for (int y = 0; y < Board::kHeight; ++y) {
-    for (int x = 0; x < Board::kWidth; ++x) {
-      int id = board.GetId(y, x);
-      if (Board::kNone == board.board(id))
-        continue;
-
-      // Float a touched orb.
-      double floating_ratio = 0.0;
-      if (id == current_position)
-        floating_ratio = 0.1;
-
-      // Draw a orb.
-      int dest_x = static_cast<int>(kImageSizeOrb * (x - floating_ratio));
-      int dest_y = static_cast<int>(kImageSizeOrb * (y - floating_ratio));
-      DrawGraph(image_orb, dest_x, dest_y, board.board(id),
-                kImageSizeOrb, kImageSizeOrb);
-    }
+  for (int i = 0; i < static_cast<int>(orbs.size()); ++i) {
+    const Animation::Orb &orb = orbs[i];
+
+    // Float a touched orb.
+    double floating_ratio = 0.0;
+    if (orb.is_held)
+      floating_ratio = 0.1;
+
+    // Draw a orb.
+    int dest_x = static_cast<int>(kImageSizeOrb * (orb.x - floating_ratio));
+    int dest_y = static_cast<int>(kImageSizeOrb * (orb.y - floating_ratio));
+    DrawGraph(image_orb, dest_x, dest_y, orb.attribute,
+              kImageSizeOrb, kImageSizeOrb, orb.alpha);
   }
 
-  Display();
+  // Overlay a hint.
+  if (hint)
+    DrawRoute(*hint);
 }
 
-void Graphic::DisplayResult(const Board::Score &score, int max_combos) {
+void Graphic::DrawResult(const Board::Score &score, int max_combos) {
   // Convert given score to string.
   char score_string[30];
   snprintf(score_string, sizeof(score_string), "%d/%d  COMBOS",
@@ -115,81 +117,46 @@ void Graphic::DisplayResult(const Board::Score &score, int max_combos) {
         image_orb_small : image_overlayed_orb_small;
     DrawGraph(orb_image, dest_x, dest_y, i, 25, 25);
   }
-
-  Display();
-}
-
-namespace {
-enum IdStatus { kIdNone = -1 };
-}
-
-void Graphic::MoveOrbs(bool *is_moving, Board *board) const {
-  static int past_id = kIdNone;
-  SDL_Event event;
-
-  while (true) {
-    // Wait for a mouse event, click.
-    SDL_WaitEvent(&event);
-    if (event.type == SDL_QUIT) {
-      exit(0);
-    } else if (event.type == SDL_MOUSEBUTTONDOWN) {
-      *is_moving = true;
-      break;
-    } else if (event.type == SDL_MOUSEBUTTONUP) {
-      *is_moving = false;
-      past_id = kIdNone;
-      break;
-    }
-
-    // Move orbs while the mouse cursor is dragging.
-    if (*is_moving) {
-      // Get a position of the mouse.
-      int x, y;
-      SDL_GetMouseState(&x, &y);
-      int mouse_position = (x / kImageSizeOrb + 1) +
-          (y / kImageSizeOrb + 1) * Board::kArrayWidth;
-
-      // Swap orbs as needed.
-      if (past_id == kIdNone) {  // Need to initialize.
-        past_id = mouse_position;
-      } else if (mouse_position != past_id) {  // Any orb was moved.
-        board->Swap(mouse_position, past_id);
-        past_id = mouse_position;
-      }
-      break;
-    }
-  }
 }
 
-void Graphic::Sleep(const int duration) const {
-  for (int i = 0; i < duration / 10; ++i) {
-    SDL_Delay(10);
-    CheckClose();
-  }
+void Graphic::Display() {
+  SDL_UpdateWindowSurface(window);
 }
 
-Graphic::Point Graphic::WaitClick() const {
+bool Graphic::WaitEvents(int timeout, std::vector<Event> *events) const {
+  // Sleep until the first event or the timeout.
   SDL_Event event;
-  while (true) {
-    SDL_WaitEvent(&event);
-
+  int has_event = (0 < timeout) ? SDL_WaitEventTimeout(&event, timeout) :
+                                  SDL_PollEvent(&event);
+  for (; has_event; has_event = SDL_PollEvent(&event)) {
     // Case that window was closed.
     if (event.type == SDL_QUIT)
-      exit(0);
+      return false;
 
-    // Case that mouse was clicked.
-    if (event.type == SDL_MOUSEBUTTONUP &&
+    // Take mouse events.
+    Event e;
+    if (event.type == SDL_MOUSEBUTTONDOWN &&
         event.button.button == SDL_BUTTON_LEFT) {
-      Point point;
-      point.x = event.button.x;
-      point.y = event.button.y;
-      return point;
+      e.type = kEventPress;
+      e.position = GetPosition(event.button.x, event.button.y);
+    } else if (event.type == SDL_MOUSEBUTTONUP &&
+               event.button.button == SDL_BUTTON_LEFT) {
+      e.type = kEventRelease;
+      e.position = GetPosition(event.button.x, event.button.y);
+    } else if (event.type == SDL_MOUSEMOTION) {
+      e.type = kEventMotion;
+      e.position = GetPosition(event.motion.x, event.motion.y);
+    } else {
+      continue;
     }
+    events->push_back(e);
   }
+  return true;
 }
 
 void Graphic::DrawGraph(SDL_Surface *image, int dest_x, int dest_y,
-                        int image_id, int image_width, int image_height) {
+                        int image_id, int image_width, int image_height,
+                        double alpha) {
   SDL_Rect src, dest;
   src.x = (image_id % 4) * image_width;
   src.y = (image_id / 4) * image_height;
@@ -197,7 +164,9 @@ void Graphic::DrawGraph(SDL_Surface *image, int dest_x, int dest_y,
   src.h = (image_height == 0) ? image->h : image_height;
   dest.x = dest_x;
   dest.y = dest_y;
+  SDL_SetSurfaceAlphaMod(image, static_cast<Uint8>(0xff * alpha));
   SDL_BlitSurface(image, &src, video_surface, &dest);
+  SDL_SetSurfaceAlphaMod(image, 0xff);
 }
 
 void Graphic::DrawString(const char *text, int dest_x, int dest_y,
@@ -213,20 +182,49 @@ void Graphic::DrawString(const char *text, int dest_x, int dest_y,
   SDL_FreeSurface(temp_text);
 }
 
-void Graphic::CheckClose() const {
-  SDL_Event event;
-  while (SDL_PollEvent(&event)) {
-    // If a window was closed.
-    if (event.type == SDL_QUIT)
-      exit(0);
+void Graphic::DrawRoute(const Solver::Route &route) {
+  const int kLineWidth = 8;
+  const int kMarkSize = 24;
+  Uint32 color = SDL_MapRGB(video_surface->format, 0x55, 0x55, 0x55);
+
+  // Connect centers of orbs along the route.
+  int position = route.begin_id;
+  for (int i = 0; i < route.size(); ++i) {
+    std::map<int, int>::const_iterator it = route.directions.find(i);
+    if (it == route.directions.end() || it->second == 0)
+      break;
+    int next_position = position + it->second;
+    int x_1 = (position % Board::kArrayWidth - 1) * kImageSizeOrb;
+    int y_1 = (position / Board::kArrayWidth - 1) * kImageSizeOrb;
+    int x_2 = (next_position % Board::kArrayWidth - 1) * kImageSizeOrb;
+    int y_2 = (next_position / Board::kArrayWidth - 1) * kImageSizeOrb;
+    SDL_Rect line;
+    line.x = std::min(x_1, x_2) + (kImageSizeOrb - kLineWidth) / 2;
+    line.y = std::min(y_1, y_2) + (kImageSizeOrb - kLineWidth) / 2;
+    line.w = std::abs(x_2 - x_1) + kLineWidth;
+    line.h = std::abs(y_2 - y_1) + kLineWidth;
+    SDL_FillRect(video_surface, &line, color);
+    position = next_position;
   }
+
+  // Mark the end of the route.
+  SDL_Rect mark;
+  mark.x = (position % Board::kArrayWidth - 1) * kImageSizeOrb +
+           (kImageSizeOrb - kMarkSize) / 2;
+  mark.y = (position / Board::kArrayWidth - 1) * kImageSizeOrb +
+           (kImageSizeOrb - kMarkSize) / 2;
+  mark.w = mark.h = kMarkSize;
+  SDL_FillRect(video_surface, &mark, color);
+}
+
+int Graphic::GetPosition(int x, int y) const {
+  if (x < 0 || kWidthWindow <= x || y < 0 || kHeightWindow <= y)
+    return 0;
+  return (x / kImageSizeOrb + 1) +
+         (y / kImageSizeOrb + 1) * Board::kArrayWidth;
 }
 
 void Graphic::ClearScreen() {
   // Draw a white plane.
   SDL_FillRect(video_surface, NULL, 0xffffff);
-}
-
-void Graphic::Display() {
-  SDL_UpdateWindowSurface(window);
 }
\ No newline at end of file
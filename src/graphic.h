@@ -8,21 +8,36 @@
 #include <SDL.h>
 #include <SDL_image.h>  // Display images.
 #include <SDL_ttf.h>    // Display texts.
+#include <vector>
+#include "animation.h"
 #include "board.h"
+#include "solver.h"
 
 class Graphic {
 public:
-  struct Point {
-    int x, y;
+  enum EventTypes {
+    kEventPress,
+    kEventRelease,
+    kEventMotion,
   };
 
-  void Initialize();
+  struct Event {
+    int type;
+    // The id of the cell under the mouse cursor, or 0 outside the board.
+    int position;
+  };
+
+  // Return false after printing the error if it fails.
+  bool Initialize();
   void Terminate();
-  void DisplayBoard(const Board &board, int current_position = 0);
-  void DisplayResult(const Board::Score &score, int max_combos);
-  void MoveOrbs(bool *is_moving, Board *board) const;
-  void Sleep(const int duration) const;
-  Point WaitClick() const;
+  // Draw a frame, and show it by "Display()".
+  void DrawBoard(const std::vector<Animation::Orb> &orbs,
+                 const Solver::Route *hint = NULL);
+  void DrawResult(const Board::Score &score, int max_combos);
+  void Display();
+  // Wait for events at most "timeout" milliseconds and take all of them
+  // without blocking further. Return false if the window is closed.
+  bool WaitEvents(int timeout, std::vector<Event> *events) const;
 
 private:
   static const int kImageSizeOrb;
@@ -31,12 +46,13 @@ private:
 
   // Unit of a image must be 4 per row.
   void DrawGraph(SDL_Surface *image, int dest_x, int dest_y,
-                 int image_id = 0, int image_width = 0, int image_height = 0);
+                 int image_id = 0, int image_width = 0, int image_height = 0,
+                 double alpha = 1.0);
   void DrawString(const char *text, int dest_x, int dest_y,
                   const SDL_Color &color);
-  void CheckClose() const;
+  void DrawRoute(const Solver::Route &route);
+  int GetPosition(int x, int y) const;
   void ClearScreen();
-  void Display();
 
   SDL_Window *window;
   SDL_Surface *video_surface;
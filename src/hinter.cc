@@ -0,0 +1,135 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "hinter.h"
+#include "mcts.h"
+
+namespace {
+// Small enough to give a hint within a frame.
+const int kNumIterationsPerSearch = 50;
+// Stop searching after this for the same board.
+const int kMaxIterations = 20000;
+const int kRolloutDepth = 10;
+const int kMaxNodes = 1 << 16;
+}  // namespace
+
+Hinter::Hinter()
+    : is_running_(false), current_id_(0), version_(0), hint_version_(-1) {}
+
+Hinter::~Hinter() {
+  Stop();
+}
+
+void Hinter::Start() {
+  if (is_running_)
+    return;
+  is_running_ = true;
+  thread_ = std::thread(&Hinter::Run, this);
+}
+
+void Hinter::Stop() {
+  if (!is_running_)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  condition_.notify_one();
+  thread_.join();
+}
+
+void Hinter::Update(const Board &board, int current_id) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (0 < version_ && current_id == current_id_ && board.Equals(board_))
+      return;
+    board_ = board;
+    current_id_ = current_id;
+    ++version_;
+  }
+  condition_.notify_one();
+}
+
+bool Hinter::GetHint(Solver::Route *hint) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hint_version_ != version_)
+    return false;
+  *hint = hint_;
+  return true;
+}
+
+void Hinter::Run() {
+  Mcts::Tree tree(kMaxNodes, 1);
+  Board searched_board;
+  int searched_id = 0;
+  int searched_version = -1;
+  int num_iterations = 0;
+  while (true) {
+    // Wait for a board to be searched.
+    Board board;
+    int current_id = 0;
+    bool is_updated = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [&] {
+        return !is_running_ || version_ != searched_version ||
+               (searched_id != 0 && num_iterations < kMaxIterations);
+      });
+      if (!is_running_)
+        break;
+      if (version_ != searched_version) {
+        board = board_;
+        current_id = current_id_;
+        searched_version = version_;
+        is_updated = true;
+      }
+    }
+
+    if (is_updated) {
+      // Follow the player's move in the tree if possible.
+      int direction = current_id - searched_id;
+      int child = -1;
+      for (int i = 0; searched_id != 0 && i < tree.num_children(); ++i) {
+        if (tree.child_move(i) == direction)
+          child = i;
+      }
+      if (0 <= child) {
+        searched_board.MoveOrb(direction, searched_id);
+        if (!searched_board.Equals(board))
+          child = -1;
+      }
+      if (current_id == 0) {
+        // The move has finished.
+      } else if (0 <= child) {
+        tree.Advance(child);
+        tree.ForgetBest();
+      } else {
+        tree.Reset(board, current_id);
+      }
+      searched_board = board;
+      searched_id = current_id;
+      num_iterations = 0;
+      if (current_id == 0)
+        continue;
+    }
+
+    tree.Search(kNumIterationsPerSearch, kRolloutDepth);
+    num_iterations += kNumIterationsPerSearch;
+
+    // Publish the rest of the best route.
+    const Solver::Route &route = tree.best_route();
+    int num_fixed_directions = tree.num_fixed_directions();
+    Solver::Route hint;
+    hint.begin_id = searched_id;
+    for (int i = num_fixed_directions; i < route.size(); ++i) {
+      std::map<int, int>::const_iterator it = route.directions.find(i);
+      if (it == route.directions.end() || it->second == 0)
+        break;
+      hint.directions[i - num_fixed_directions] = it->second;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    hint_ = hint;
+    hint_version_ = searched_version;
+  }
+}
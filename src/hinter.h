@@ -0,0 +1,45 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_HINTER_H_
+#define PUZZLE_AND_DRAGOONS_HINTER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "board.h"
+#include "solver.h"
+
+// Search for the best continuation of a player's move in a background
+// thread. The search tree is kept while the player follows it.
+class Hinter {
+public:
+  Hinter();
+  ~Hinter();
+
+  void Start();
+  void Stop();
+  // Give the board being moved and the id of the touched orb, or 0 after
+  // the move. This never waits for the search.
+  void Update(const Board &board, int current_id);
+  // Return false if there is no hint for the last board yet.
+  bool GetHint(Solver::Route *hint) const;
+
+private:
+  void Run();
+
+  std::thread thread_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  bool is_running_;
+  // The last board given.
+  Board board_;
+  int current_id_;
+  int version_;
+  // A hint for "board_" if "hint_version_" equals "version_".
+  Solver::Route hint_;
+  int hint_version_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_HINTER_H_
@@ -0,0 +1,119 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "histogram.h"
+#include <algorithm>  // std::min(), std::max()
+#include <cmath>      // ceil()
+
+namespace {
+// "value" must be positive.
+int FindMostSignificantBit(long long value) {
+#if defined(__GNUC__)
+  return 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+#else
+  int bit = 0;
+  for (; value >>= 1;)
+    ++bit;
+  return bit;
+#endif
+}
+}  // namespace
+
+Histogram::Snapshot Histogram::Snapshot::Subtract(
+    const Snapshot &before) const {
+  Snapshot difference = *this;
+  int highest_bucket = -1;
+  for (int i = 0; i < static_cast<int>(counts.size()); ++i) {
+    difference.counts[i] -= before.counts[i];
+    if (0 < difference.counts[i])
+      highest_bucket = i;
+  }
+
+  // A value recorded during the previous snapshot can be counted here with
+  // its maximum taken by that snapshot, so keep the maximum in its bucket.
+  difference.max = recent_max;
+  if (0 <= highest_bucket)
+    difference.max = std::max(recent_max, GetLowestValue(highest_bucket));
+  return difference;
+}
+
+long long Histogram::Snapshot::count() const {
+  long long count = 0;
+  for (int i = 0; i < static_cast<int>(counts.size()); ++i)
+    count += counts[i];
+  return count;
+}
+
+long long Histogram::Snapshot::GetValueAtPercentile(double percentile) const {
+  long long num_values = count();
+  if (num_values == 0)
+    return 0;
+
+  // Find the bucket including the value of the rank.
+  long long rank =
+      static_cast<long long>(ceil(percentile / 100.0 * num_values));
+  rank = std::max(1LL, std::min(rank, num_values));
+  long long accumulation = 0;
+  for (int i = 0; i < static_cast<int>(counts.size()); ++i) {
+    accumulation += counts[i];
+    if (rank <= accumulation)
+      return std::min(GetHighestValue(i), max);
+  }
+  return max;
+}
+
+Histogram::Histogram() : max_(0), recent_max_(0) {
+  for (int i = 0; i < kNumBuckets; ++i)
+    counts_[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::Record(long long value) {
+  if (value < 0)
+    value = 0;
+  counts_[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+  // Update the maximums.
+  long long max = max_.load(std::memory_order_relaxed);
+  while (max < value &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+  max = recent_max_.load(std::memory_order_relaxed);
+  while (max < value &&
+         !recent_max_.compare_exchange_weak(max, value,
+                                            std::memory_order_relaxed)) {}
+}
+
+Histogram::Snapshot Histogram::TakeSnapshot() {
+  Snapshot snapshot;
+  snapshot.counts.resize(kNumBuckets);
+  for (int i = 0; i < kNumBuckets; ++i)
+    snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+  snapshot.max = max_.load(std::memory_order_relaxed);
+  snapshot.recent_max = recent_max_.exchange(0, std::memory_order_relaxed);
+  return snapshot;
+}
+
+int Histogram::GetBucket(long long value) {
+  if (value < kNumSubBuckets)
+    return static_cast<int>(value);
+
+  // Keep the most significant bits of the value.
+  int shift = FindMostSignificantBit(value) - kSubBucketBits + 1;
+  int top = static_cast<int>(value >> shift);
+  return kNumSubBuckets + (shift - 1) * (kNumSubBuckets / 2) +
+         (top - kNumSubBuckets / 2);
+}
+
+long long Histogram::GetLowestValue(int bucket) {
+  return (bucket == 0) ? 0 : GetHighestValue(bucket - 1) + 1;
+}
+
+long long Histogram::GetHighestValue(int bucket) {
+  if (bucket < kNumSubBuckets)
+    return bucket;
+
+  int shift = (bucket - kNumSubBuckets) / (kNumSubBuckets / 2) + 1;
+  long long top = (bucket - kNumSubBuckets) % (kNumSubBuckets / 2) +
+                  kNumSubBuckets / 2;
+  return ((top + 1) << shift) - 1;
+}
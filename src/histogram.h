@@ -0,0 +1,54 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_HISTOGRAM_H_
+#define PUZZLE_AND_DRAGOONS_HISTOGRAM_H_
+
+#include <atomic>
+#include <vector>
+
+// A histogram of non-negative values like HdrHistogram. Each bucket covers
+// values within 1/32 relative error, and any thread can record values
+// without locks.
+class Histogram {
+public:
+  // Counts of buckets at a moment. Differences of them give statistics
+  // between moments.
+  struct Snapshot {
+    // Values recorded after "before", which must be the previous snapshot
+    // of the histogram.
+    Snapshot Subtract(const Snapshot &before) const;
+    long long count() const;
+    // The largest value in the bucket at the "percentile".
+    long long GetValueAtPercentile(double percentile) const;
+
+    std::vector<long long> counts;
+    long long max;
+    // The maximum of values recorded after the previous snapshot.
+    long long recent_max;
+  };
+
+  Histogram();
+
+  void Record(long long value);
+  // Start a new interval of "recent_max" of snapshots.
+  Snapshot TakeSnapshot();
+
+private:
+  static const int kSubBucketBits = 6;
+  static const int kNumSubBuckets = 1 << kSubBucketBits;
+  // Buckets for values less than "kNumSubBuckets" and then each power of 2.
+  static const int kNumBuckets =
+      kNumSubBuckets + (62 - kSubBucketBits + 1) * (kNumSubBuckets / 2);
+
+  static int GetBucket(long long value);
+  static long long GetLowestValue(int bucket);
+  static long long GetHighestValue(int bucket);
+
+  std::atomic<long long> counts_[kNumBuckets];
+  std::atomic<long long> max_;
+  std::atomic<long long> recent_max_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_HISTOGRAM_H_
@@ -0,0 +1,85 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "lookahead.h"
+#include <algorithm>  // std::max()
+#include <climits>    // INT_MIN
+#include <random>
+#include <vector>
+#include "board.h"
+
+const Lookahead::Settings Lookahead::kDefaultSettings = {16, 50};
+
+Lookahead::Lookahead() : settings_(kDefaultSettings) {}
+
+Lookahead::Lookahead(const Settings &settings,
+                     const Ai::Settings &search_settings)
+    : settings_(settings), ai_(search_settings) {}
+
+Solver::Route Lookahead::Search(const Board &original_board,
+                                long long *num_nodes) const {
+  // Routes searched for the turn are the candidates.
+  std::vector<Route> routes;
+  std::vector<int> scores;
+  ai_.SearchCandidates(original_board, &routes, &scores, num_nodes);
+  int num_routes = static_cast<int>(routes.size());
+  std::vector<Board> boards(num_routes, original_board);
+  std::vector<int> combos(num_routes);
+  int max_combos = 0;
+  for (int i = 0; i < num_routes; ++i) {
+    combos[i] = MoveAlongRoute(routes[i], &boards[i]);
+    max_combos = std::max(max_combos, combos[i]);
+  }
+
+  // Don't lose combos certainly for estimated ones, and prefer the
+  // evaluation of the search among routes of the same value.
+  Route best_route;
+  int best_value = INT_MIN;
+  int best_score = INT_MIN;
+  for (int i = 0; i < num_routes; ++i) {
+    if (combos[i] < max_combos)
+      continue;
+    int value = EvaluateBoard(boards[i], combos[i]);
+    if (best_value < value || (best_value == value && best_score < scores[i])) {
+      best_value = value;
+      best_score = scores[i];
+      best_route = routes[i];
+    }
+  }
+
+  return best_route;
+}
+
+int Lookahead::MoveAlongRoute(Route route, Board *board) {
+  int current_position = route.begin_id;
+  for (int i = 0; i < route.size(); ++i) {
+    int direction = route.directions[i];
+    if (0 == direction)
+      break;
+    board->MoveOrb(direction, current_position);
+    current_position += direction;
+  }
+  return board->VanishOrbs().sum_combos;
+}
+
+int Lookahead::EvaluateBoard(const Board &board, int num_combos) const {
+  // Every route gets the same samples to be compared fairly.
+  std::mt19937 random;
+  int value = 0;
+  for (int i = 0; i < settings_.num_samples; ++i) {
+    // Cascade until no orbs vanish.
+    Board next_board = board;
+    int sum_combos = num_combos;
+    for (int combos = num_combos; 0 < combos; sum_combos += combos) {
+      next_board.DropOrbs(&random);
+      combos = next_board.VanishOrbs().sum_combos;
+    }
+
+    // The leftover board bounds combos of the next turn.
+    value += sum_combos * 100 +
+             next_board.CalculateMaxCombos() * settings_.next_turn_weight;
+  }
+
+  return value;
+}
@@ -0,0 +1,45 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_LOOKAHEAD_H_
+#define PUZZLE_AND_DRAGOONS_LOOKAHEAD_H_
+
+#include "ai.h"
+#include "solver.h"
+
+// Choose among routes found by the phased depth-first search by combos of
+// the turn plus the maximum combos of the next board, which is estimated
+// from orbs left after vanishing and samples of new orbs.
+class Lookahead : public Solver {
+public:
+  struct Settings {
+    // The number of samples of new orbs for each route.
+    int num_samples;
+    // Weight in percent of a combo of the next board against a combo of the
+    // turn.
+    int next_turn_weight;
+  };
+
+  static const Settings kDefaultSettings;
+
+  Lookahead();
+  Lookahead(const Settings &settings, const Ai::Settings &search_settings);
+
+protected:
+  Route Search(const Board &original_board,
+               long long *num_nodes) const override;
+
+private:
+  // Move orbs of "board" along "route", vanish them and return the combos.
+  static int MoveAlongRoute(Route route, Board *board);
+  // Return the sum over samples of 100 times combos of the turn including
+  // cascades, plus the weighted maximum combos of the next board. "board"
+  // has vanished "num_combos" combos.
+  int EvaluateBoard(const Board &board, int num_combos) const;
+
+  Settings settings_;
+  Ai ai_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_LOOKAHEAD_H_
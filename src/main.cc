@@ -5,6 +5,8 @@
 // 2014/11/08: Project was created.
 //-----------------------------------------------------------------------------
 
+#include <cstdio>
+#include <cstring>  // strcmp()
 #include "game.h"
 
 // NOTE: Comment out below to use SDL in VS2015 or later versions.
@@ -17,10 +19,55 @@ extern "C" FILE * __cdecl __iob_func() {
 // NOTE: When we use SDL, "SDLInitialize()" and "SDLFinalize()"
 // must be called from "main()". Moreover, "main()" must be
 // "int main(int argc, char *argv[])" and return "0".
+//
+// Usage: app [--play] [--hint] [--solver NAME] [--trace FILE] [--stats FILE]
+//   --play         A player solves the puzzle instead of the ai.
+//   --hint         The ai shows hints while the player moves an orb.
+//   --solver NAME  The ai uses "dfs" (default), "mcts", "plan" or
+//                  "lookahead".
+//   --trace FILE   Append each turn to FILE for "replay".
+//   --stats FILE   Append percentiles of turn statistics to FILE every minute.
 int main(int argc, char *argv[]) {
+  bool is_playing = false;
+  bool shows_hints = false;
+  const char *solver_name = "dfs";
+  const char *trace_path = NULL;
+  const char *stats_path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--play") == 0)
+      is_playing = true;
+    else if (strcmp(argv[i], "--hint") == 0)
+      is_playing = shows_hints = true;
+    else if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc)
+      solver_name = argv[++i];
+    else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+      trace_path = argv[++i];
+    else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+      stats_path = argv[++i];
+  }
+  Solver *solver = Solver::Create(solver_name);
+  if (!solver) {
+    fprintf(stderr, "ERROR: Unknown solver %s\n", solver_name);
+    return 1;
+  }
+
+  // Return instead of exit() so that traces and statistics are flushed.
   Game game;
-  game.Initialize();
-  game.SolveAuto();
+  if (!game.Initialize()) {
+    delete solver;
+    return 1;
+  }
+  if (trace_path && !game.OpenTrace(trace_path, solver_name)) {
+    fprintf(stderr, "ERROR: Can't open %s as a trace of %s\n",
+            trace_path, solver_name);
+  }
+  if (stats_path && !game.OpenStatistics(stats_path))
+    fprintf(stderr, "ERROR: Can't open %s\n", stats_path);
+  if (is_playing)
+    game.Play(shows_hints);
+  else
+    game.SolveAuto(*solver);
   game.Terminate();
+  delete solver;
   return 0;
 }
\ No newline at end of file
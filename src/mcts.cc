@@ -0,0 +1,275 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "mcts.h"
+#include <algorithm>  // std::max()
+#include <climits>    // INT_MIN
+#include <cmath>      // sqrt(), log()
+#include <thread>
+
+namespace {
+// Weight of exploration in UCT.
+const double kExploration = 0.1;
+}  // namespace
+
+const Mcts::Settings Mcts::kDefaultSettings = {30, 500, 10, 1, 1 << 16};
+
+Mcts::Mcts() : settings_(kDefaultSettings) {}
+
+Mcts::Mcts(const Settings &settings) : settings_(settings) {}
+
+Mcts::Route Mcts::Search(const Board &original_board,
+                         long long *num_nodes) const {
+  // Each thread searches its own tree, and they vote for the next move.
+  int num_threads = std::max(1, settings_.num_threads);
+  std::vector<Tree> trees;
+  for (int t = 0; t < num_threads; ++t) {
+    trees.push_back(Tree(settings_.max_nodes, t + 1));
+    trees[t].Reset(original_board, 0);
+  }
+
+  // The first step chooses a start and the others move it.
+  for (int step = 0; step <= settings_.max_route_length; ++step) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.push_back(std::thread([&, t] {
+        trees[t].Search(settings_.num_iterations, settings_.rollout_depth);
+      }));
+    }
+    for (int t = 0; t < num_threads; ++t)
+      threads[t].join();
+
+    // Fix the most visited move.
+    int best_child = -1;
+    int best_visits = 0;
+    for (int i = 0; i < trees[0].num_children(); ++i) {
+      int visits = 0;
+      for (int t = 0; t < num_threads; ++t)
+        visits += trees[t].child_visits(i);
+      if (best_visits < visits) {
+        best_visits = visits;
+        best_child = i;
+      }
+    }
+    if (best_child < 0)
+      break;
+    for (int t = 0; t < num_threads; ++t)
+      trees[t].Advance(best_child);
+  }
+
+  // Return the best route found by any thread.
+  int best_tree = 0;
+  for (int t = 0; t < num_threads; ++t) {
+    *num_nodes += trees[t].num_nodes();
+    if (trees[best_tree].best_evaluation() < trees[t].best_evaluation())
+      best_tree = t;
+  }
+  return trees[best_tree].best_route();
+}
+
+Mcts::Tree::Tree(int max_nodes, unsigned int seed)
+    : max_nodes_(std::max(max_nodes, 1 + Board::kSize)), root_(0),
+      random_(seed), reward_scale_(1.0), num_fixed_moves_(0),
+      best_evaluation_(INT_MIN), num_nodes_(0) {}
+
+void Mcts::Tree::Reset(const Board &board, int begin_id) {
+  root_state_.board = board;
+  root_state_.current_id = begin_id;
+  root_state_.prev_direction = 0;
+  reward_scale_ = 1.0 / (10000.0 * std::max(1, board.CalculateMaxCombos()));
+  moves_.clear();
+  if (begin_id != 0)
+    moves_.push_back(begin_id);
+  num_fixed_moves_ = static_cast<int>(moves_.size());
+  best_route_ = Route();
+  best_route_.begin_id = begin_id;
+  best_evaluation_ = INT_MIN;
+  num_nodes_ = 0;
+  nodes_.reserve(max_nodes_);
+  Rebuild();
+}
+
+void Mcts::Tree::Search(int num_iterations, int rollout_depth) {
+  for (int i = 0; i < num_iterations; ++i) {
+    // Select a leaf along UCT.
+    State state = root_state_;
+    moves_.resize(num_fixed_moves_);
+    int path[Board::kSize * 4];
+    int path_size = 0;
+    int node = root_;
+    path[path_size++] = node;
+    while (0 < nodes_[node].num_children &&
+           path_size < static_cast<int>(sizeof(path) / sizeof(path[0]))) {
+      node = SelectChild(node);
+      state.Move(nodes_[node].move);
+      moves_.push_back(nodes_[node].move);
+      path[path_size++] = node;
+    }
+
+    // Expand the leaf if it was visited before.
+    if (0 < nodes_[node].visits && Expand(node, state) &&
+        path_size < static_cast<int>(sizeof(path) / sizeof(path[0]))) {
+      node = nodes_[node].first_child;
+      state.Move(nodes_[node].move);
+      moves_.push_back(nodes_[node].move);
+      path[path_size++] = node;
+    }
+
+    // Evaluate the leaf and a random continuation of it.
+    int evaluation = INT_MIN;
+    if (state.current_id != 0) {
+      evaluation = state.board.Evaluate();
+      UpdateBest(evaluation, static_cast<int>(moves_.size()));
+    }
+    evaluation = std::max(evaluation, Rollout(rollout_depth, &state));
+    double reward = evaluation * reward_scale_;
+    num_nodes_ += static_cast<int>(moves_.size()) - num_fixed_moves_;
+
+    // Back up the reward.
+    for (int j = 0; j < path_size; ++j) {
+      ++nodes_[path[j]].visits;
+      nodes_[path[j]].total_reward += reward;
+    }
+  }
+}
+
+void Mcts::Tree::Advance(int i) {
+  int child = nodes_[root_].first_child + i;
+  root_state_.Move(nodes_[child].move);
+  moves_.resize(num_fixed_moves_);
+  moves_.push_back(nodes_[child].move);
+  num_fixed_moves_ = static_cast<int>(moves_.size());
+
+  // Reuse the subtree unless the arena is getting full.
+  root_ = child;
+  if (static_cast<int>(nodes_.size()) <= max_nodes_ / 2 &&
+      (0 < nodes_[root_].num_children || Expand(root_, root_state_))) {
+    return;
+  }
+  Rebuild();
+}
+
+void Mcts::Tree::ForgetBest() {
+  best_route_ = Route();
+  best_route_.begin_id = moves_.empty() ? 0 : moves_[0];
+  best_evaluation_ = INT_MIN;
+}
+
+int Mcts::Tree::num_fixed_directions() const {
+  // The first move is the start.
+  return std::max(0, num_fixed_moves_ - 1);
+}
+
+int Mcts::Tree::child_move(int i) const {
+  return nodes_[nodes_[root_].first_child + i].move;
+}
+
+int Mcts::Tree::child_visits(int i) const {
+  return nodes_[nodes_[root_].first_child + i].visits;
+}
+
+void Mcts::Tree::State::Move(int move) {
+  if (current_id == 0) {
+    current_id = move;
+    return;
+  }
+  board.MoveOrb(move, current_id);
+  current_id += move;
+  prev_direction = move;
+}
+
+void Mcts::Tree::Rebuild() {
+  nodes_.clear();
+  Node root = {0, 0, 0, 0, 0.0};
+  nodes_.push_back(root);
+  root_ = 0;
+  Expand(root_, root_state_);
+}
+
+bool Mcts::Tree::Expand(int node, const State &state) {
+  if (max_nodes_ < static_cast<int>(nodes_.size()) + Board::kSize)
+    return false;
+
+  int first_child = static_cast<int>(nodes_.size());
+  Node child = {0, 0, 0, 0, 0.0};
+  if (state.current_id == 0) {
+    // Choose a start.
+    for (int y = 0; y < Board::kHeight; ++y) {
+      for (int x = 0; x < Board::kWidth; ++x) {
+        child.move = state.board.GetId(y, x);
+        nodes_.push_back(child);
+      }
+    }
+  } else {
+    // Move the orb except going back.
+    for (int i = 0; i < 4; ++i) {
+      int direction = Board::k4Directions[i];
+      if (Board::kOutside == state.board.board(state.current_id + direction) ||
+          direction == -state.prev_direction) {
+        continue;
+      }
+      child.move = direction;
+      nodes_.push_back(child);
+    }
+  }
+  nodes_[node].first_child = first_child;
+  nodes_[node].num_children = static_cast<int>(nodes_.size()) - first_child;
+  return true;
+}
+
+int Mcts::Tree::SelectChild(int node) const {
+  const Node &parent = nodes_[node];
+  double log_visits = log(static_cast<double>(std::max(1, parent.visits)));
+  int best_child = parent.first_child;
+  double best_value = -1e100;
+  for (int i = 0; i < parent.num_children; ++i) {
+    const Node &child = nodes_[parent.first_child + i];
+    if (child.visits == 0)
+      return parent.first_child + i;
+    double value = child.total_reward / child.visits +
+                   kExploration * sqrt(log_visits / child.visits);
+    if (best_value < value) {
+      best_value = value;
+      best_child = parent.first_child + i;
+    }
+  }
+  return best_child;
+}
+
+int Mcts::Tree::Rollout(int rollout_depth, State *state) {
+  if (state->current_id == 0 || rollout_depth <= 0)
+    return INT_MIN;
+
+  for (int i = 0; i < rollout_depth; ++i) {
+    // Move the orb randomly except going back.
+    int directions[4];
+    int num_directions = 0;
+    for (int j = 0; j < 4; ++j) {
+      int direction = Board::k4Directions[j];
+      if (Board::kOutside != state->board.board(state->current_id + direction) &&
+          direction != -state->prev_direction) {
+        directions[num_directions++] = direction;
+      }
+    }
+    int direction = directions[random_() % num_directions];
+    state->Move(direction);
+    moves_.push_back(direction);
+  }
+
+  int evaluation = state->board.Evaluate();
+  UpdateBest(evaluation, static_cast<int>(moves_.size()));
+  return evaluation;
+}
+
+void Mcts::Tree::UpdateBest(int evaluation, int num_moves) {
+  if (evaluation <= best_evaluation_)
+    return;
+
+  // The first move is the start unless it was given.
+  best_evaluation_ = evaluation;
+  best_route_.begin_id = moves_[0];
+  best_route_.directions.clear();
+  for (int i = 1; i < num_moves; ++i)
+    best_route_.directions[i - 1] = moves_[i];
+}
@@ -0,0 +1,108 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_MCTS_H_
+#define PUZZLE_AND_DRAGOONS_MCTS_H_
+
+#include <random>
+#include <vector>
+#include "board.h"
+#include "solver.h"
+
+// Search for a route by Monte Carlo tree search. Moves are fixed one by one
+// so that long routes are searched in time proportional to their length.
+class Mcts : public Solver {
+public:
+  struct Settings {
+    // The maximum number of moves to be fixed.
+    int max_route_length;
+    // The number of simulations per thread to fix a move.
+    int num_iterations;
+    // The number of random moves after a leaf.
+    int rollout_depth;
+    // The number of threads searching their own trees.
+    int num_threads;
+    // The number of nodes allocated per tree.
+    int max_nodes;
+  };
+
+  // A search tree whose nodes are allocated in a preallocated arena.
+  class Tree {
+  public:
+    Tree(int max_nodes, unsigned int seed);
+
+    // Start a search from "board". "begin_id" is 0 to choose a start too.
+    void Reset(const Board &board, int begin_id);
+    void Search(int num_iterations, int rollout_depth);
+    // Fix the next move to that of the "i"th child of the root.
+    void Advance(int i);
+    // Forget the best route to find one following the fixed moves.
+    void ForgetBest();
+
+    int num_children() const { return nodes_[root_].num_children; }
+    int child_move(int i) const;
+    int child_visits(int i) const;
+    // The best route found after "Reset()" or "ForgetBest()".
+    const Route &best_route() const { return best_route_; }
+    // The number of directions of the route fixed by "Advance()".
+    int num_fixed_directions() const;
+    int best_evaluation() const { return best_evaluation_; }
+    // The number of boards simulated after "Reset()".
+    long long num_nodes() const { return num_nodes_; }
+
+  private:
+    struct Node {
+      int first_child;
+      int num_children;
+      // A direction, or an id of a start at the first move.
+      int move;
+      int visits;
+      double total_reward;
+    };
+
+    // A board with an orb being moved.
+    struct State {
+      void Move(int move);
+
+      Board board;
+      int current_id;
+      int prev_direction;
+    };
+
+    void Rebuild();
+    // Return false if there is no room for children.
+    bool Expand(int node, const State &state);
+    int SelectChild(int node) const;
+    int Rollout(int rollout_depth, State *state);
+    void UpdateBest(int evaluation, int num_moves);
+
+    int max_nodes_;
+    std::vector<Node> nodes_;
+    int root_;
+    State root_state_;
+    std::mt19937 random_;
+    // To normalize evaluations into rewards.
+    double reward_scale_;
+    // Moves from the beginning of the search to the current simulation.
+    std::vector<int> moves_;
+    int num_fixed_moves_;
+    Route best_route_;
+    int best_evaluation_;
+    long long num_nodes_;
+  };
+
+  static const Settings kDefaultSettings;
+
+  Mcts();
+  explicit Mcts(const Settings &settings);
+
+protected:
+  Route Search(const Board &original_board,
+               long long *num_nodes) const override;
+
+private:
+  Settings settings_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_MCTS_H_
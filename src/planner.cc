@@ -0,0 +1,358 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "planner.h"
+#include <algorithm>  // std::min(), std::shuffle(), std::stable_sort()
+#include <climits>    // INT_MAX
+#include <cstdlib>    // abs()
+#include <random>
+
+namespace {
+// Larger than any distance to move orbs.
+const int kShortagePenalty = 1000;
+
+int CountCombos(const Board &board) {
+  Board copy_board = board;
+  return copy_board.VanishOrbs().sum_combos;
+}
+
+// Place 3 orbs of each combo side by side in a row, and the others in the
+// rest of the board.
+Board CreateArrangement(const Board &board, std::mt19937 *random) {
+  int num_orbs[Board::kNumAttributes] = {0};
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x)
+      ++num_orbs[board.board(y, x)];
+  }
+  std::vector<int> combos;
+  std::vector<int> rests;
+  for (int i = 0; i < Board::kNumAttributes; ++i) {
+    combos.insert(combos.end(), num_orbs[i] / 3, i);
+    rests.insert(rests.end(), num_orbs[i] % 3, i);
+  }
+  std::shuffle(combos.begin(), combos.end(), *random);
+  std::shuffle(rests.begin(), rests.end(), *random);
+
+  // Fill slots of 3 cells in random order.
+  const int kNumSlots = Board::kSize / 3;
+  std::vector<int> slots(kNumSlots);
+  for (int i = 0; i < kNumSlots; ++i)
+    slots[i] = i;
+  std::shuffle(slots.begin(), slots.end(), *random);
+  int orbs[Board::kSize];
+  for (int i = 0, j = 0; i < kNumSlots; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      int cell = slots[i] * 3 + k;
+      orbs[cell] = (i < static_cast<int>(combos.size())) ?
+          combos[i] : rests[j++];
+    }
+  }
+
+  Board arrangement;
+  arrangement.Load(orbs);
+  return arrangement;
+}
+
+// Minimum cost of a perfect matching of "n" rows and "n" columns.
+int SolveAssignment(const int costs[][Board::kSize], int n) {
+  // Hungarian algorithm with 1-based potentials.
+  int u[Board::kSize + 1] = {0};
+  int v[Board::kSize + 1] = {0};
+  int matched_rows[Board::kSize + 1] = {0};
+  int ways[Board::kSize + 1];
+  for (int i = 1; i <= n; ++i) {
+    matched_rows[0] = i;
+    int j0 = 0;
+    int min_values[Board::kSize + 1];
+    bool is_used[Board::kSize + 1];
+    for (int j = 0; j <= n; ++j) {
+      min_values[j] = INT_MAX;
+      is_used[j] = false;
+    }
+    do {
+      is_used[j0] = true;
+      int i0 = matched_rows[j0];
+      int delta = INT_MAX;
+      int j1 = 0;
+      for (int j = 1; j <= n; ++j) {
+        if (is_used[j])
+          continue;
+        int value = costs[i0 - 1][j - 1] - u[i0] - v[j];
+        if (value < min_values[j]) {
+          min_values[j] = value;
+          ways[j] = j0;
+        }
+        if (min_values[j] < delta) {
+          delta = min_values[j];
+          j1 = j;
+        }
+      }
+      for (int j = 0; j <= n; ++j) {
+        if (is_used[j]) {
+          u[matched_rows[j]] += delta;
+          v[j] -= delta;
+        } else {
+          min_values[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (matched_rows[j0] != 0);
+    do {
+      int j1 = ways[j0];
+      matched_rows[j0] = matched_rows[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+  return -v[0];
+}
+
+// The minimum total distance to move misplaced orbs of "attribute" to cells
+// of the attribute in "target". The orb at "held_id" moves for nothing.
+int CalculateDistance(const Board &board, const Board &target,
+                      int attribute, int held_id) {
+  int orbs[Board::kSize];
+  int holes[Board::kSize];
+  int num_orbs = 0;
+  int num_holes = 0;
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x) {
+      int id = board.GetId(y, x);
+      if (board.board(id) == target.board(id))
+        continue;
+      if (board.board(id) == attribute)
+        orbs[num_orbs++] = id;
+      if (target.board(id) == attribute)
+        holes[num_holes++] = id;
+    }
+  }
+  if (num_orbs == 0)
+    return 0;
+
+  int costs[Board::kSize][Board::kSize];
+  for (int i = 0; i < num_orbs; ++i) {
+    for (int j = 0; j < num_holes; ++j) {
+      int difference_y = orbs[i] / Board::kArrayWidth -
+                         holes[j] / Board::kArrayWidth;
+      int difference_x = orbs[i] % Board::kArrayWidth -
+                         holes[j] % Board::kArrayWidth;
+      costs[i][j] = (orbs[i] == held_id) ? 0 :
+          std::abs(difference_y) + std::abs(difference_x);
+    }
+  }
+  return SolveAssignment(costs, num_orbs);
+}
+
+int CalculateDistance(const Board &board, const Board &target) {
+  int distance = 0;
+  for (int i = 0; i < Board::kNumAttributes; ++i)
+    distance += CalculateDistance(board, target, i, 0);
+  return distance;
+}
+
+// IDA* to transform a board into any of targets. A move carries exactly one
+// orb other than the held one by 1 cell, so the distance to move the other
+// orbs is an admissible heuristic, which is weighted to find routes faster.
+class PathFinder {
+public:
+  PathFinder(const std::vector<Board> &targets, int weight,
+             long long max_nodes)
+      : targets_(targets), weight_(weight), max_nodes_(max_nodes),
+        num_nodes_(0), best_distance_(INT_MAX) {}
+
+  // Return false if no route is found within the limit of nodes.
+  bool Search(const Board &board, Solver::Route *route);
+
+  long long num_nodes() const { return num_nodes_; }
+
+private:
+  bool SearchFromNode(int current_id, int prev_direction);
+  int GetHeuristic() const;
+  void UpdateBest();
+
+  const std::vector<Board> &targets_;
+  const Board *target_;
+  int weight_;
+  Board board_;
+  // Distances each attribute.
+  int distances_[Board::kNumAttributes];
+  long long max_nodes_;
+  long long num_nodes_;
+  int bound_;
+  int next_bound_;
+  std::vector<int> directions_;
+  int begin_id_;
+  // The route getting closest to any target.
+  Solver::Route best_route_;
+  int best_distance_;
+};
+
+bool PathFinder::Search(const Board &board, Solver::Route *route) {
+  board_ = board;
+  bound_ = 0;
+
+  // Deepen the bound of the length of routes.
+  while (bound_ != INT_MAX && num_nodes_ < max_nodes_) {
+    next_bound_ = INT_MAX;
+    for (int i = 0; i < static_cast<int>(targets_.size()); ++i) {
+      target_ = &targets_[i];
+      for (int y = 0; y < Board::kHeight; ++y) {
+        for (int x = 0; x < Board::kWidth; ++x) {
+          begin_id_ = board_.GetId(y, x);
+          for (int j = 0; j < Board::kNumAttributes; ++j) {
+            distances_[j] =
+                CalculateDistance(board_, *target_, j, begin_id_);
+          }
+          directions_.clear();
+          if (!SearchFromNode(begin_id_, 0))
+            continue;
+          route->begin_id = begin_id_;
+          route->directions.clear();
+          for (int j = 0; j < static_cast<int>(directions_.size()); ++j)
+            route->directions[j] = directions_[j];
+          return true;
+        }
+      }
+    }
+    bound_ = next_bound_;
+  }
+
+  *route = best_route_;
+  return false;
+}
+
+bool PathFinder::SearchFromNode(int current_id, int prev_direction) {
+  int heuristic = GetHeuristic();
+  int cost = static_cast<int>(directions_.size()) + weight_ * heuristic;
+  if (bound_ < cost) {
+    next_bound_ = std::min(next_bound_, cost);
+    return false;
+  }
+  UpdateBest();
+  if (heuristic == 0 && board_.Equals(*target_))
+    return true;
+  if (max_nodes_ <= num_nodes_)
+    return false;
+
+  for (int i = 0; i < 4; ++i) {
+    int direction = Board::k4Directions[i];
+    int dest = current_id + direction;
+    if (Board::kOutside == board_.board(dest) || direction == -prev_direction)
+      continue;
+
+    // Update distances of the moved orbs.
+    board_.MoveOrb(direction, current_id);
+    ++num_nodes_;
+    int held_attribute = board_.board(dest);
+    int other_attribute = board_.board(current_id);
+    int held_distance = distances_[held_attribute];
+    int other_distance = distances_[other_attribute];
+    distances_[held_attribute] =
+        CalculateDistance(board_, *target_, held_attribute, dest);
+    distances_[other_attribute] =
+        CalculateDistance(board_, *target_, other_attribute, dest);
+
+    directions_.push_back(direction);
+    if (SearchFromNode(dest, direction))
+      return true;
+    directions_.pop_back();
+
+    distances_[other_attribute] = other_distance;
+    distances_[held_attribute] = held_distance;
+    board_.MoveOrb(-direction, dest);
+  }
+  return false;
+}
+
+int PathFinder::GetHeuristic() const {
+  int heuristic = 0;
+  for (int i = 0; i < Board::kNumAttributes; ++i)
+    heuristic += distances_[i];
+  return heuristic;
+}
+
+void PathFinder::UpdateBest() {
+  int distance = GetHeuristic();
+  if (best_distance_ < distance ||
+      (best_distance_ == distance &&
+       best_route_.size() <= static_cast<int>(directions_.size()))) {
+    return;
+  }
+  best_distance_ = distance;
+  best_route_.begin_id = begin_id_;
+  best_route_.directions.clear();
+  for (int j = 0; j < static_cast<int>(directions_.size()); ++j)
+    best_route_.directions[j] = directions_[j];
+}
+}  // namespace
+
+const Planner::Settings Planner::kDefaultSettings = {4, 1000, 3, 1000000};
+
+Planner::Planner() : settings_(kDefaultSettings) {}
+
+Planner::Planner(const Settings &settings) : settings_(settings) {}
+
+Planner::Route Planner::Search(const Board &original_board,
+                               long long *num_nodes) const {
+  std::vector<Board> targets = PlanTargets(original_board);
+  Route route;
+  route.begin_id = original_board.GetId(0, 0);
+  if (targets.empty())
+    return route;
+
+  PathFinder path_finder(targets, settings_.heuristic_weight,
+                         settings_.max_nodes);
+  path_finder.Search(original_board, &route);
+  *num_nodes += path_finder.num_nodes();
+  return route;
+}
+
+std::vector<Board> Planner::PlanTargets(const Board &board) const {
+  // Minimize shortage of combos first and then distance to move orbs.
+  const int max_combos = board.CalculateMaxCombos();
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> random_cell(0, Board::kSize - 1);
+  std::vector<std::pair<int, Board> > targets;
+  for (int i = 0; i < settings_.num_targets; ++i) {
+    // Start from the board itself once.
+    Board target = (i == 0) ? board : CreateArrangement(board, &random);
+    int cost = (max_combos - CountCombos(target)) * kShortagePenalty +
+               CalculateDistance(board, target);
+    for (int j = 0; j < settings_.num_refinements; ++j) {
+      int cell_1 = random_cell(random);
+      int cell_2 = random_cell(random);
+      int id_1 = target.GetId(cell_1 / Board::kWidth, cell_1 % Board::kWidth);
+      int id_2 = target.GetId(cell_2 / Board::kWidth, cell_2 % Board::kWidth);
+      if (target.board(id_1) == target.board(id_2))
+        continue;
+      target.Swap(id_1, id_2);
+      int next_cost = (max_combos - CountCombos(target)) * kShortagePenalty +
+                      CalculateDistance(board, target);
+      if (next_cost <= cost)
+        cost = next_cost;
+      else
+        target.Swap(id_1, id_2);
+    }
+    // Keep different arrangements only.
+    bool is_new = true;
+    for (int j = 0; j < static_cast<int>(targets.size()); ++j)
+      is_new = is_new && !targets[j].second.Equals(target);
+    if (is_new)
+      targets.push_back(std::make_pair(cost, target));
+  }
+
+  std::stable_sort(targets.begin(), targets.end(),
+                   [](const std::pair<int, Board> &a,
+                      const std::pair<int, Board> &b) {
+                     return a.first < b.first;
+                   });
+  // Aim at arrangements achieving the maximum combos, or at the one closest
+  // to it if none does, rather than not moving at all.
+  std::vector<Board> sorted_targets;
+  for (int i = 0; i < static_cast<int>(targets.size()); ++i) {
+    if (0 < i && kShortagePenalty <= targets[i].first)
+      break;
+    sorted_targets.push_back(targets[i].second);
+  }
+  return sorted_targets;
+}
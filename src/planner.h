@@ -0,0 +1,46 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_PLANNER_H_
+#define PUZZLE_AND_DRAGOONS_PLANNER_H_
+
+#include <vector>
+#include "board.h"
+#include "solver.h"
+
+// Plan arrangements of orbs achieving the maximum combos first, and then
+// search for a short route to any of them by weighted IDA*.
+class Planner : public Solver {
+public:
+  struct Settings {
+    // The number of arrangements to be planned.
+    int num_targets;
+    // The number of swaps to bring each arrangement close to the board.
+    int num_refinements;
+    // Routes are at most this times longer than the shortest one. 1 finds
+    // the shortest routes but takes much more time.
+    int heuristic_weight;
+    // The maximum number of boards searched for routes. The route closest
+    // to any arrangement is returned after that.
+    long long max_nodes;
+  };
+
+  static const Settings kDefaultSettings;
+
+  Planner();
+  explicit Planner(const Settings &settings);
+
+protected:
+  Route Search(const Board &original_board,
+               long long *num_nodes) const override;
+
+private:
+  // Return arrangements achieving the maximum combos sorted by the number of
+  // orbs to be moved, or the closest one if none does.
+  std::vector<Board> PlanTargets(const Board &board) const;
+
+  Settings settings_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_PLANNER_H_
@@ -0,0 +1,302 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "reference_board.h"
+#include <cstdlib>  // rand()
+#include <queue>
+
+namespace {
+int ClassifyShape(const bool cells[Board::kHeight][Board::kWidth], int size) {
+  for (int y = 0; y < Board::kHeight; ++y) {
+    int x = 0;
+    while (x < Board::kWidth && cells[y][x])
+      ++x;
+    if (x == Board::kWidth)
+      return Board::kShapeRow;
+  }
+  if (size == 4)
+    return Board::kShapeFour;
+  if (size != 5)
+    return Board::kShapeNormal;
+
+  // Find a center of a cross and the bounding box.
+  int top = Board::kHeight, bottom = 0, left = Board::kWidth, right = 0;
+  for (int y = 0; y < Board::kHeight; ++y) {
+    for (int x = 0; x < Board::kWidth; ++x) {
+      if (!cells[y][x])
+        continue;
+      if (0 < y && y < Board::kHeight - 1 && 0 < x && x < Board::kWidth - 1 &&
+          cells[y - 1][x] && cells[y + 1][x] &&
+          cells[y][x - 1] && cells[y][x + 1]) {
+        return Board::kShapeCross;
+      }
+      if (y < top) top = y;
+      if (bottom < y) bottom = y;
+      if (x < left) left = x;
+      if (right < x) right = x;
+    }
+  }
+
+  // An L fills a row and a column of a 3x3 box sharing a corner.
+  if (bottom - top == 2 && right - left == 2) {
+    const int corners[4][2] = {
+      {top, left}, {top, right}, {bottom, left}, {bottom, right},
+    };
+    for (int i = 0; i < 4; ++i) {
+      int y = corners[i][0];
+      int x = corners[i][1];
+      bool is_l = true;
+      for (int j = 0; j < 3; ++j) {
+        if (!cells[y][left + j] || !cells[top + j][x])
+          is_l = false;
+      }
+      if (is_l)
+        return Board::kShapeL;
+    }
+  }
+  return Board::kShapeFive;
+}
+}  // namespace
+
+void ReferenceBoard::Load(const Board &board) {
+  for (int i = 0; i < kArraySize; ++i)
+    set_board(i, board.board(i));
+}
+
+Board::Score ReferenceBoard::VanishOrbs() {
+  ReferenceBoard next_board = *this;
+
+  // Create a map for saving vanished orbs.
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      int attribute = board(id);
+
+      // Check whether there are orbs having
+      // current orb's attribute on right and bottom side.
+      for (int i = 2; i < 4; ++i) {
+        // Count the number of connected orbs of
+        // same attribute each other.
+        int j = 1;
+        for (j = 1; board(id + Board::k4Directions[i] * j) == attribute;
+             ++j) {}
+
+        // Vanish connected orbs.
+        if (j < Board::kConnectionMinNum)
+          continue;
+        for (--j; 0 <= j; --j) {
+          int dest = id + Board::k4Directions[i] * j;
+          next_board.set_board(dest, Board::kTemp);
+        }
+      }
+    }
+  }
+
+  Board::Score information = {0};
+  std::queue<int> connected_orbs;
+
+  // Get information about vanished orbs.
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      int attribute = board(id);
+      if (Board::kTemp != next_board.board(id))
+        continue;
+
+      // If the current orb is going to be vanished,
+      // trace connected orbs of the same attribute
+      // to get information about them.
+      ++information.sum_combos;
+      ++information.num_combos[attribute];
+      bool cells[kHeight][kWidth] = {{false}};
+      int size = 0;
+
+      // Trace connected orbs of the same attribute.
+      connected_orbs.push(id);
+      next_board.set_board(id, Board::kNone);
+      do {
+        int temp_id = connected_orbs.front();
+        connected_orbs.pop();
+        ++information.sum_orbs;
+        ++information.num_orbs[attribute];
+        cells[temp_id / kArrayWidth - 1][temp_id % kArrayWidth - 1] = true;
+        ++size;
+
+        // Search for 4 directions recursively.
+        for (int i = 0; i < 4; ++i) {
+          int dest = temp_id + Board::k4Directions[i];
+          if (Board::kTemp == next_board.board(dest) &&
+              attribute == board(dest)) {
+            connected_orbs.push(dest);
+            next_board.set_board(dest, Board::kNone);
+          }
+        }
+      } while (!connected_orbs.empty());
+
+      // Record the group.
+      if (information.num_groups < Board::kMaxGroups) {
+        Board::Group &group = information.groups[information.num_groups++];
+        group.attribute = attribute;
+        group.size = size;
+        group.shape = ClassifyShape(cells, size);
+        group.cells = 0;
+        for (int cy = 0; cy < kHeight; ++cy) {
+          for (int cx = 0; cx < kWidth; ++cx) {
+            if (cells[cy][cx])
+              group.cells |= 1u << (cy * kWidth + cx);
+          }
+        }
+      }
+    }
+  }
+
+  // Vanish orbs.
+  for (int i = 0; i < kArraySize; ++i)
+    set_board(i, next_board.board(i));
+
+  return information;
+}
+
+void ReferenceBoard::DropOrbs(std::mt19937 *random) {
+  // Drop orbs first if there are empties.
+  for (int y = kHeight - 1; 0 <= y; --y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int current = GetId(y, x);
+      if (Board::kNone != board(current))
+        continue;
+
+      // If a orb is not existed at current position,
+      // search for a orb from current position to top.
+      int j;
+      for (j = current - kArrayWidth;
+           board(j) == Board::kNone;
+           j -= kArrayWidth) {}
+
+      // Drop a orb above the current position.
+      if (board(j) != Board::kOutside)
+        Swap(current, j);
+    }
+  }
+
+  // Add new orbs into the empties.
+  AddNewOrbs(random);
+}
+
+void ReferenceBoard::MoveOrb(int direction, int src) {
+  int dest = src + direction;
+  Swap(src, dest);
+}
+
+bool ReferenceBoard::Equals(const Board &target) const {
+  for (int i = 0; i < kArraySize; ++i) {
+    if (target.board(i) != board(i))
+      return false;
+  }
+  return true;
+}
+
+int ReferenceBoard::Evaluate() const {
+  // Get a score.
+  ReferenceBoard copy_board = *this;
+  Board::Score score = copy_board.VanishOrbs();
+
+  // Get each parameters.
+  int num_orbs_on_edge = copy_board.CountNumOrbsOnEdge();
+  int perimeter = copy_board.CalculatePerimeter();
+  int farthest_distance = copy_board.MeasureFarthestOrbsDistance();
+
+  // Weight each parameters.
+  int evaluation =
+      score.sum_combos * 10000 -
+      num_orbs_on_edge * 300 -
+      farthest_distance * 300 -
+      perimeter;
+
+  return evaluation;
+}
+
+int ReferenceBoard::CalculatePerimeter() const {
+  int perimeter = 0;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      if (Board::kNone == board(id)) {
+        // Search for 4 directions.
+        for (int i = 0; i < 4; ++i) {
+          int dest = id + Board::k4Directions[i];
+          int dest_orb = board(dest);
+          if (Board::kNone != dest_orb)
+            perimeter++;
+        }
+      }
+    }
+  }
+  return perimeter;
+}
+
+int ReferenceBoard::MeasureFarthestOrbsDistance() const {
+  // Find the first orb and last one.
+  int first_orb = 0;
+  int last_orb = 0;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      if (!IsOrb(id))
+        continue;
+      if (first_orb == 0)
+        first_orb = id;
+      last_orb = id;
+    }
+  }
+
+  // Calculate the Manhattan distance between them.
+  int difference = last_orb - first_orb;
+  int difference_y =
+    difference / kArrayWidth - 1;
+  int difference_x =
+    difference % kArrayWidth - 1;
+  int farthest_distance = difference_y + difference_x;
+  return farthest_distance;
+}
+
+int ReferenceBoard::CountNumOrbsOnEdge() const {
+  int num_orbs_on_edge = 0;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      if (IsOrb(id) && IsEdge(y, x))
+        num_orbs_on_edge++;
+    }
+  }
+  return num_orbs_on_edge;
+}
+
+void ReferenceBoard::AddNewOrbs(std::mt19937 *random) {
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      int id = GetId(y, x);
+      if (Board::kNone == board(id))
+        set_board(id, (random ? (*random)() : rand()) %
+                          Board::kNumAttributes);
+    }
+  }
+}
+
+void ReferenceBoard::Swap(int id_1, int id_2) {
+  int board_id_1 = board(id_1);
+  set_board(id_1, board_[id_2]);
+  set_board(id_2, board_id_1);
+}
+
+int ReferenceBoard::GetId(int y, int x) const {
+  return (x + 1) + (y + 1) * kArrayWidth;
+}
+
+bool ReferenceBoard::IsOrb(int id) const {
+  return 0 <= board(id);
+}
+
+bool ReferenceBoard::IsEdge(int y, int x) const {
+  return y == 0 || x == 0 || y == kHeight - 1 || x == kWidth - 1;
+}
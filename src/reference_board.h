@@ -0,0 +1,47 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_REFERENCE_BOARD_H_
+#define PUZZLE_AND_DRAGOONS_REFERENCE_BOARD_H_
+
+#include "board.h"
+
+// The original scalar implementation of "Board". This is an oracle which
+// optimized implementations must match exactly, so keep it simple and
+// don't optimize it.
+class ReferenceBoard {
+public:
+  void Load(const Board &board);
+  // Return information about vanished orbs. Orbs must not be empty.
+  Board::Score VanishOrbs();
+  // New orbs come from "random", or from rand() if it is NULL.
+  void DropOrbs(std::mt19937 *random = NULL);
+  void MoveOrb(int direction, int src);
+  bool Equals(const Board &target) const;
+  // Orbs must not be empty.
+  int Evaluate() const;
+
+  int board(int id) const { return board_[id]; }
+
+private:
+  static const int kWidth = Board::kWidth;
+  static const int kHeight = Board::kHeight;
+  static const int kArrayWidth = Board::kArrayWidth;
+  static const int kArraySize = Board::kArraySize;
+
+  int CalculatePerimeter() const;
+  int MeasureFarthestOrbsDistance() const;
+  int CountNumOrbsOnEdge() const;
+  void AddNewOrbs(std::mt19937 *random);
+  void Swap(int id_1, int id_2);
+  int GetId(int y, int x) const;
+  bool IsOrb(int id) const;
+  bool IsEdge(int y, int x) const;
+
+  void set_board(int id, int attribute) { board_[id] = attribute; }
+
+  int board_[kArraySize];
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_REFERENCE_BOARD_H_
@@ -0,0 +1,31 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "solver.h"
+#include <cstring>  // strcmp()
+#include "ai.h"
+#include "lookahead.h"
+#include "mcts.h"
+#include "planner.h"
+
+Solver *Solver::Create(const char *name) {
+  if (strcmp(name, "dfs") == 0)
+    return new Ai();
+  if (strcmp(name, "mcts") == 0)
+    return new Mcts();
+  if (strcmp(name, "plan") == 0)
+    return new Planner();
+  if (strcmp(name, "lookahead") == 0)
+    return new Lookahead();
+  return NULL;
+}
+
+Solver::Route Solver::GetBestRoute(const Board &original_board,
+                                   long long *num_nodes) const {
+  long long num_searched_nodes = 0;
+  Route route = Search(original_board, &num_searched_nodes);
+  if (num_nodes)
+    *num_nodes += num_searched_nodes;
+  return route;
+}
@@ -0,0 +1,38 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_SOLVER_H_
+#define PUZZLE_AND_DRAGOONS_SOLVER_H_
+
+#include <cstddef>  // NULL
+#include <map>
+
+class Board;
+
+// An interface of algorithms to find a route to move orbs.
+class Solver {
+public:
+  struct Route {
+    int size() const { return directions.size(); }
+
+    int begin_id;
+    std::map<int, int> directions;
+  };
+
+  // Return a new solver named "name", or NULL if it is unknown.
+  // "dfs", "mcts", "plan" and "lookahead" are available.
+  static Solver *Create(const char *name);
+
+  virtual ~Solver() {}
+  // Add the number of boards searched to "num_nodes" unless it is NULL.
+  Route GetBestRoute(const Board &original_board,
+                     long long *num_nodes = NULL) const;
+
+protected:
+  // "num_nodes" is initialized to 0.
+  virtual Route Search(const Board &original_board,
+                       long long *num_nodes) const = 0;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_SOLVER_H_
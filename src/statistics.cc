@@ -0,0 +1,119 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "statistics.h"
+#include <chrono>
+#include <ctime>  // time(), strftime()
+
+namespace {
+const char *const kMetricNames[Statistics::kNumMetrics] = {
+  "think_time_us",
+  "animation_time_us",
+  "cascade_depth",
+  "missed_combos",
+};
+
+void PrintSnapshot(FILE *file, const char *time_string, const char *name,
+                   const char *window, const Histogram::Snapshot &snapshot) {
+  fprintf(file, "%s %-18s %-8s n=%lld p50=%lld p90=%lld p99=%lld max=%lld\n",
+          time_string, name, window, snapshot.count(),
+          snapshot.GetValueAtPercentile(50.0),
+          snapshot.GetValueAtPercentile(90.0),
+          snapshot.GetValueAtPercentile(99.0),
+          snapshot.GetValueAtPercentile(100.0));
+}
+}  // namespace
+
+const long Statistics::kMaxFileSize = 1 << 20;
+const int Statistics::kNumOldFiles = 3;
+
+Statistics::Statistics() : file_(NULL), interval_(0), is_closing_(false) {}
+
+Statistics::~Statistics() {
+  Close();
+}
+
+bool Statistics::Open(const char *path, int interval) {
+  Close();
+  path_ = path;
+  file_ = fopen(path, "a");
+  if (!file_)
+    return false;
+  interval_ = interval;
+  for (int i = 0; i < kNumMetrics; ++i)
+    prev_snapshots_[i] = histograms_[i].TakeSnapshot();
+
+  is_closing_ = false;
+  thread_ = std::thread(&Statistics::Run, this);
+  return true;
+}
+
+void Statistics::Close() {
+  if (!thread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_closing_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+
+  // Write the rest.
+  WriteSnapshots();
+  if (file_)
+    fclose(file_);
+  file_ = NULL;
+}
+
+void Statistics::Record(int metric, long long value) {
+  histograms_[metric].Record(value);
+}
+
+void Statistics::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_closing_) {
+    if (condition_.wait_for(lock, std::chrono::seconds(interval_),
+                            [this] { return is_closing_; })) {
+      break;
+    }
+    lock.unlock();
+    WriteSnapshots();
+    lock.lock();
+  }
+}
+
+void Statistics::WriteSnapshots() {
+  if (!file_)
+    return;
+  char time_string[32];
+  time_t now = time(NULL);
+  strftime(time_string, sizeof(time_string), "%Y-%m-%dT%H:%M:%S",
+           localtime(&now));
+
+  // Write statistics in the last interval and in total.
+  for (int i = 0; i < kNumMetrics; ++i) {
+    Histogram::Snapshot snapshot = histograms_[i].TakeSnapshot();
+    PrintSnapshot(file_, time_string, kMetricNames[i], "interval",
+                  snapshot.Subtract(prev_snapshots_[i]));
+    PrintSnapshot(file_, time_string, kMetricNames[i], "total", snapshot);
+    prev_snapshots_[i] = snapshot;
+  }
+  fflush(file_);
+
+  if (kMaxFileSize <= ftell(file_))
+    Rotate();
+}
+
+void Statistics::Rotate() {
+  fclose(file_);
+
+  // Shift old files and start a new one.
+  for (int i = kNumOldFiles - 1; 0 <= i; --i) {
+    std::string from = (i == 0) ? path_ : path_ + "." + std::to_string(i);
+    std::string to = path_ + "." + std::to_string(i + 1);
+    remove(to.c_str());
+    rename(from.c_str(), to.c_str());
+  }
+  file_ = fopen(path_.c_str(), "a");
+}
@@ -0,0 +1,57 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_STATISTICS_H_
+#define PUZZLE_AND_DRAGOONS_STATISTICS_H_
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "histogram.h"
+
+// Statistics of turns for long runs. Values are recorded from any thread,
+// and a background thread appends their percentiles to a file at intervals.
+class Statistics {
+public:
+  enum Metrics {
+    kThinkTime,      // In microseconds.
+    kAnimationTime,  // In microseconds.
+    kCascadeDepth,   // The number of waves with combos.
+    kMissedCombos,   // The maximum combos minus achieved ones.
+    kNumMetrics,
+  };
+
+  Statistics();
+  ~Statistics();
+
+  // Write statistics every "interval" seconds. "path" is renamed with
+  // suffixes ".1", ".2", ... when it gets large.
+  bool Open(const char *path, int interval);
+  void Close();
+  void Record(int metric, long long value);
+
+private:
+  // The maximum size of a file.
+  static const long kMaxFileSize;
+  // The number of old files kept.
+  static const int kNumOldFiles;
+
+  void Run();
+  void WriteSnapshots();
+  void Rotate();
+
+  Histogram histograms_[kNumMetrics];
+  Histogram::Snapshot prev_snapshots_[kNumMetrics];
+  std::string path_;
+  FILE *file_;
+  int interval_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool is_closing_;
+};
+
+#endif  // PUZZLE_AND_DRAGOONS_STATISTICS_H_
@@ -0,0 +1,250 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include "trace.h"
+#include <cstring>  // memcmp(), memcpy()
+
+namespace {
+const char kMagic[4] = {'P', 'A', 'D', 'T'};
+// Version 2 follows the header with the name of the solver, whose length is
+// the last byte of the header.
+const unsigned char kVersion = 2;
+const int kHeaderSize = 8;
+
+void Put8(int value, std::vector<unsigned char> *bytes) {
+  bytes->push_back(static_cast<unsigned char>(value));
+}
+
+void Put16(int value, std::vector<unsigned char> *bytes) {
+  Put8(value, bytes);
+  Put8(value >> 8, bytes);
+}
+
+void Put32(unsigned int value, std::vector<unsigned char> *bytes) {
+  Put16(value & 0xffff, bytes);
+  Put16(value >> 16, bytes);
+}
+
+bool Get8(FILE *file, int *value) {
+  int c = fgetc(file);
+  *value = c;
+  return c != EOF;
+}
+
+bool Get16(FILE *file, int *value) {
+  int low, high;
+  if (!Get8(file, &low) || !Get8(file, &high))
+    return false;
+  *value = low | (high << 8);
+  return true;
+}
+
+bool Get32(FILE *file, unsigned int *value) {
+  int low, high;
+  if (!Get16(file, &low) || !Get16(file, &high))
+    return false;
+  *value = static_cast<unsigned int>(low) |
+           (static_cast<unsigned int>(high) << 16);
+  return true;
+}
+
+// Orbs and directions are small signed values.
+int ToSigned8(int value) {
+  return (value < 0x80) ? value : value - 0x100;
+}
+}  // namespace
+
+namespace trace {
+Writer::Writer() : file_(NULL), is_closing_(false) {}
+
+Writer::~Writer() {
+  Close();
+}
+
+bool Writer::Open(const char *path, const std::string &solver_name) {
+  Close();
+  if (0xff < solver_name.size())
+    return false;
+
+  // Write a header only into a new file, and append turns only of the same
+  // solver.
+  file_ = fopen(path, "ab");
+  if (!file_)
+    return false;
+  fseek(file_, 0, SEEK_END);
+  if (ftell(file_) == 0) {
+    unsigned char header[kHeaderSize] = {0};
+    memcpy(header, kMagic, sizeof(kMagic));
+    header[4] = kVersion;
+    header[5] = Board::kWidth;
+    header[6] = Board::kHeight;
+    header[7] = static_cast<unsigned char>(solver_name.size());
+    fwrite(header, 1, sizeof(header), file_);
+    fwrite(solver_name.data(), 1, solver_name.size(), file_);
+    fflush(file_);
+  } else {
+    Reader reader;
+    if (!reader.Open(path) || reader.solver_name() != solver_name) {
+      fclose(file_);
+      file_ = NULL;
+      return false;
+    }
+  }
+
+  is_closing_ = false;
+  thread_ = std::thread(&Writer::Run, this);
+  return true;
+}
+
+void Writer::Close() {
+  if (!file_)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_closing_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+  fclose(file_);
+  file_ = NULL;
+}
+
+void Writer::Write(const Turn &turn) {
+  if (!file_)
+    return;
+
+  // Serialize the turn here and leave only I/O to the thread.
+  std::vector<unsigned char> bytes;
+  Put8(turn.mode, &bytes);
+  Put32(turn.seed, &bytes);
+  Put32(turn.think_time, &bytes);
+  for (int i = 0; i < Board::kSize; ++i)
+    Put8(turn.orbs[i], &bytes);
+  Put8(turn.begin_id, &bytes);
+  Put16(static_cast<int>(turn.directions.size()), &bytes);
+  for (int i = 0; i < static_cast<int>(turn.directions.size()); ++i)
+    Put8(turn.directions[i], &bytes);
+  Put8(static_cast<int>(turn.waves.size()), &bytes);
+  for (int i = 0; i < static_cast<int>(turn.waves.size()); ++i) {
+    Put8(turn.waves[i].sum_orbs, &bytes);
+    Put8(turn.waves[i].sum_combos, &bytes);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+  }
+  condition_.notify_one();
+}
+
+void Writer::Run() {
+  std::vector<unsigned char> bytes;
+  while (true) {
+    // Take over written turns.
+    bool is_closing;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return is_closing_ || !buffer_.empty(); });
+      bytes.swap(buffer_);
+      is_closing = is_closing_;
+    }
+
+    if (!bytes.empty()) {
+      fwrite(&bytes[0], 1, bytes.size(), file_);
+      fflush(file_);
+      bytes.clear();
+    }
+    if (is_closing)
+      break;
+  }
+}
+
+Reader::Reader() : file_(NULL), is_broken_(false) {}
+
+Reader::~Reader() {
+  Close();
+}
+
+bool Reader::Open(const char *path) {
+  Close();
+  is_broken_ = false;
+  file_ = fopen(path, "rb");
+  if (!file_)
+    return false;
+
+  // Check the header.
+  unsigned char header[kHeaderSize];
+  if (fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+      memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      (header[4] != 1 && header[4] != kVersion) ||
+      header[5] != Board::kWidth || header[6] != Board::kHeight) {
+    Close();
+    return false;
+  }
+
+  // Read the name of the solver.
+  solver_name_.clear();
+  if (header[4] == kVersion) {
+    solver_name_.resize(header[7]);
+    if (fread(&solver_name_[0], 1, header[7], file_) != header[7]) {
+      Close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void Reader::Close() {
+  if (!file_)
+    return;
+  fclose(file_);
+  file_ = NULL;
+}
+
+bool Reader::Read(Turn *turn) {
+  if (!file_ || is_broken_)
+    return false;
+
+  // The file may end only between turns.
+  if (!Get8(file_, &turn->mode))
+    return false;
+  is_broken_ = !ReadRest(turn);
+  return !is_broken_;
+}
+
+bool Reader::ReadRest(Turn *turn) {
+  int value;
+  if (!Get32(file_, &turn->seed) || !Get32(file_, &turn->think_time))
+    return false;
+  for (int i = 0; i < Board::kSize; ++i) {
+    if (!Get8(file_, &value))
+      return false;
+    turn->orbs[i] = ToSigned8(value);
+  }
+  if (!Get8(file_, &turn->begin_id))
+    return false;
+
+  int num_directions;
+  if (!Get16(file_, &num_directions))
+    return false;
+  turn->directions.resize(num_directions);
+  for (int i = 0; i < num_directions; ++i) {
+    if (!Get8(file_, &value))
+      return false;
+    turn->directions[i] = ToSigned8(value);
+  }
+
+  int num_waves;
+  if (!Get8(file_, &num_waves))
+    return false;
+  turn->waves.resize(num_waves);
+  for (int i = 0; i < num_waves; ++i) {
+    if (!Get8(file_, &turn->waves[i].sum_orbs) ||
+        !Get8(file_, &turn->waves[i].sum_combos)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace trace
@@ -0,0 +1,91 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef PUZZLE_AND_DRAGOONS_TRACE_H_
+#define PUZZLE_AND_DRAGOONS_TRACE_H_
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+
+// A binary record of turns. A file consists of a header with the name of the
+// solver and turns, and is only appended while a game is running.
+namespace trace {
+enum Modes {
+  kModeAi,
+  kModePlayer,
+};
+
+struct Wave {
+  int sum_orbs;
+  int sum_combos;
+};
+
+struct Turn {
+  int mode;
+  // Orbs before moving in order of rows.
+  int orbs[Board::kSize];
+  // A seed set just before vanishing orbs.
+  unsigned int seed;
+  int begin_id;
+  // Differences of ids between each position of the moved orb.
+  std::vector<int> directions;
+  // Scores of each wave of vanishing, excluding no combo.
+  std::vector<Wave> waves;
+  // Time to determine the route in microseconds.
+  unsigned int think_time;
+};
+
+// Write turns in a background thread so that the game never waits for I/O.
+class Writer {
+public:
+  Writer();
+  ~Writer();
+
+  // Fail if "path" is a trace of another solver than "solver_name".
+  bool Open(const char *path, const std::string &solver_name);
+  void Close();
+  void Write(const Turn &turn);
+
+private:
+  void Run();
+
+  FILE *file_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<unsigned char> buffer_;
+  bool is_closing_;
+};
+
+class Reader {
+public:
+  Reader();
+  ~Reader();
+
+  bool Open(const char *path);
+  void Close();
+  // Return false at the end of the file or at a broken turn, which
+  // is_broken() tells apart.
+  bool Read(Turn *turn);
+  // Whether the last turn read was cut off or otherwise unreadable.
+  bool is_broken() const { return is_broken_; }
+  // Empty for traces of version 1, which don't record the solver.
+  const std::string &solver_name() const { return solver_name_; }
+
+private:
+  // Read a turn after its mode.
+  bool ReadRest(Turn *turn);
+
+  FILE *file_;
+  std::string solver_name_;
+  bool is_broken_;
+};
+}  // namespace trace
+
+#endif  // PUZZLE_AND_DRAGOONS_TRACE_H_
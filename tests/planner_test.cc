@@ -0,0 +1,48 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#include <cstdio>
+#include "board.h"
+#include "planner.h"
+
+namespace {
+int MoveAndVanish(const Solver::Route &route, Board *board) {
+  int current_position = route.begin_id;
+  for (int i = 0; i < route.size(); ++i) {
+    int direction = route.directions.find(i)->second;
+    board->MoveOrb(direction, current_position);
+    current_position += direction;
+  }
+  return board->VanishOrbs().sum_combos;
+}
+}  // namespace
+
+int main() {
+  // 18 orbs of an attribute make 6 combos only if no 2 of the combos touch,
+  // but the other 12 orbs are too few to separate them. The maximum combos
+  // of 10 are unreachable, and the planner must still move orbs.
+  const int kOrbs[Board::kSize] = {
+    0, 0, 1, 0, 0, 2,
+    0, 3, 0, 0, 4, 0,
+    1, 0, 0, 2, 0, 0,
+    0, 3, 0, 4, 0, 1,
+    2, 0, 3, 0, 4, 0,
+  };
+  Board board;
+  board.Load(kOrbs);
+  int max_combos = board.CalculateMaxCombos();
+  Board copy_board = board;
+  int original_combos = copy_board.VanishOrbs().sum_combos;
+
+  Planner planner;
+  Solver::Route route = planner.GetBestRoute(board);
+  int combos = MoveAndVanish(route, &board);
+  printf("max combos %d, %d combos before and %d after %d moves\n",
+         max_combos, original_combos, combos, route.size());
+  if (route.size() == 0 || combos <= original_combos) {
+    fprintf(stderr, "FAILED: the planner didn't improve the board.\n");
+    return 1;
+  }
+  return 0;
+}
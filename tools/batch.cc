@@ -0,0 +1,724 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+// Solve a corpus of boards in worker processes and append the results to a
+// file. Running again with the same file resumes after the boards solved.
+//
+// Usage: batch [--workers N] [--solver NAME] [--boards N] [--trace FILE]
+//              [--chunk N] OUTPUT
+//   --workers N    The number of worker processes (default: all cores).
+//   --solver NAME  The solver (default: dfs).
+//   --boards N     Solve boards created with seeds 1 to N (default: 1000).
+//   --trace FILE   Solve boards of turns in FILE instead.
+//   --chunk N      The number of boards given to a worker at once
+//                  (default: 64).
+//
+// OUTPUT starts with "# solver NAME boards N corpus SOURCE", where SOURCE is
+// "seeds" or the path of the trace, and a run is resumed only with the same
+// header. Each following line is "index combos max_combos length nodes
+// time", where time is in microseconds.
+//
+// Workers connect to the Unix socket OUTPUT.sock and talk with lines:
+//   worker: "HELLO slot"    Sent first with the slot of its ring buffer.
+//   worker: "READY"         Sent when the worker needs boards.
+//   driver: "TASK begin end"  Solve boards from "begin" to "end" - 1.
+//   driver: "QUIT"          No boards are left.
+// Results are written into a ring buffer of the slot in shared memory
+// before "READY" is sent.
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>  // atoi(), atoll(), exit()
+#include <cstring>  // memcpy(), strcmp(), strncpy()
+#include <deque>
+#include <new>  // Placement new.
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "board.h"
+#include "solver.h"
+#include "trace.h"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// The number of results held by a ring buffer.
+const int kRingSize = 1024;
+// The number of times to restart crashed workers in a run. Workers which
+// have quit normally are restarted freely when boards are given back.
+const int kMaxRestarts = 100;
+// Interval in milliseconds to collect results.
+const int kPollInterval = 10;
+
+struct Result {
+  long long index;
+  int combos;
+  int max_combos;
+  int length;
+  long long num_nodes;
+  unsigned int think_time;
+};
+
+// Results from a worker to the driver in shared memory. Only the worker
+// advances "head" and only the driver advances "tail", so a crashed worker
+// never blocks others.
+struct Ring {
+  std::atomic<unsigned long long> head;
+  std::atomic<unsigned long long> tail;
+  Result results[kRingSize];
+};
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Atomics in shared memory must be lock-free.");
+
+// Return false if the driver "parent" stops while the ring is full.
+bool Push(Ring *ring, const Result &result, pid_t parent) {
+  unsigned long long head = ring->head.load(std::memory_order_relaxed);
+  while (head - ring->tail.load(std::memory_order_acquire) == kRingSize) {
+    if (getppid() != parent)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ring->results[head % kRingSize] = result;
+  ring->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+void Pop(Ring *ring, std::vector<Result> *results) {
+  unsigned long long tail = ring->tail.load(std::memory_order_relaxed);
+  unsigned long long head = ring->head.load(std::memory_order_acquire);
+  for (; tail < head; ++tail)
+    results->push_back(ring->results[tail % kRingSize]);
+  ring->tail.store(tail, std::memory_order_release);
+}
+
+// Boards created with seeds, or orbs read from a trace.
+class Corpus {
+public:
+  Corpus() : num_boards_(0) {}
+
+  void CreateFromSeeds(long long num_boards) {
+    num_boards_ = num_boards;
+    source_ = "seeds";
+  }
+
+  bool Load(const char *path) {
+    trace::Reader reader;
+    if (!reader.Open(path))
+      return false;
+    source_ = path;
+    trace::Turn turn;
+    while (reader.Read(&turn)) {
+      for (int i = 0; i < Board::kSize; ++i)
+        orbs_.push_back(static_cast<unsigned char>(turn.orbs[i]));
+    }
+    if (reader.is_broken())
+      return false;
+    num_boards_ = orbs_.size() / Board::kSize;
+    return true;
+  }
+
+  long long size() const { return num_boards_; }
+  const std::string &source() const { return source_; }
+
+  Board Get(long long index) const {
+    Board board;
+    if (orbs_.empty()) {
+      board.Initialize(static_cast<unsigned int>(index + 1));
+    } else {
+      int orbs[Board::kSize];
+      for (int i = 0; i < Board::kSize; ++i)
+        orbs[i] = orbs_[index * Board::kSize + i];
+      board.Load(orbs);
+    }
+    return board;
+  }
+
+private:
+  long long num_boards_;
+  // "seeds" or the path of the trace.
+  std::string source_;
+  std::vector<unsigned char> orbs_;
+};
+
+Result Solve(const Solver &solver, const Board &original_board,
+             long long index) {
+  Board board = original_board;
+  Result result = {index};
+  result.max_combos = board.CalculateMaxCombos();
+
+  Clock::time_point begin_time = Clock::now();
+  Solver::Route route = solver.GetBestRoute(board, &result.num_nodes);
+  result.think_time = static_cast<unsigned int>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now() - begin_time).count());
+
+  // Move orbs along the route.
+  int current_position = route.begin_id;
+  for (; result.length < route.size(); ++result.length) {
+    int direction = route.directions[result.length];
+    if (0 == direction)
+      break;
+    board.MoveOrb(direction, current_position);
+    current_position += direction;
+  }
+
+  // Count combos without dropping orbs to exclude luck.
+  result.combos = board.VanishOrbs().sum_combos;
+  return result;
+}
+
+bool SendLine(int fd, const std::string &line) {
+  std::string data = line + "\n";
+  for (size_t sent = 0; sent < data.size();) {
+    ssize_t size = write(fd, data.data() + sent, data.size() - sent);
+    if (size <= 0)
+      return false;
+    sent += size;
+  }
+  return true;
+}
+
+// Move a complete line from "buffer" into "line" if any.
+bool TakeLine(std::string *buffer, std::string *line) {
+  size_t end = buffer->find('\n');
+  if (end == std::string::npos)
+    return false;
+  *line = buffer->substr(0, end);
+  buffer->erase(0, end + 1);
+  return true;
+}
+
+// Read from "fd" into "buffer". Return false at the end or an error.
+bool Receive(int fd, std::string *buffer) {
+  char data[256];
+  ssize_t size = read(fd, data, sizeof(data));
+  if (size <= 0)
+    return false;
+  buffer->append(data, size);
+  return true;
+}
+
+int Connect(const char *path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address),
+              sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int RunWorker(const char *socket_path, int slot, Ring *ring,
+              const Corpus &corpus, const char *solver_name) {
+  pid_t parent = getppid();
+  int fd = Connect(socket_path);
+  Solver *solver = Solver::Create(solver_name);
+  if (fd < 0 || !solver)
+    return 1;
+
+  // Solve boards given until no boards are left.
+  std::string buffer, line;
+  bool is_connected = SendLine(fd, "HELLO " + std::to_string(slot));
+  while (is_connected && SendLine(fd, "READY")) {
+    while (!TakeLine(&buffer, &line)) {
+      if (!Receive(fd, &buffer)) {
+        is_connected = false;
+        break;
+      }
+    }
+    long long begin, end;
+    if (!is_connected ||
+        sscanf(line.c_str(), "TASK %lld %lld", &begin, &end) != 2) {
+      break;
+    }
+    for (long long i = begin; is_connected && i < end; ++i)
+      is_connected = Push(ring, Solve(*solver, corpus.Get(i), i), parent);
+  }
+  delete solver;
+  close(fd);
+  return 0;
+}
+
+// The socket to be removed when the driver is stopped by a signal. Only
+// async-signal-safe functions may touch it in the handler.
+char stopped_socket_path[sizeof(sockaddr_un().sun_path)];
+
+void RemoveSocket(int signal_number) {
+  unlink(stopped_socket_path);
+  signal(signal_number, SIG_DFL);
+  raise(signal_number);
+}
+
+const int kStopSignals[] = {SIGINT, SIGTERM, SIGHUP};
+
+class Driver {
+public:
+  Driver(const Corpus &corpus, const char *solver_name, long long chunk)
+      : corpus_(corpus), solver_name_(solver_name), chunk_(chunk),
+        listener_(-1), output_(NULL), rings_(NULL), num_solved_(0),
+        sum_quality_(0.0), sum_time_(0.0) {}
+
+  ~Driver() {
+    if (0 <= listener_) {
+      close(listener_);
+      unlink(socket_path_.c_str());
+    }
+    if (output_)
+      fclose(output_);
+    if (rings_)
+      munmap(rings_, sizeof(Ring) * workers_.size());
+  }
+
+  // Print the reason to stderr if it fails.
+  bool Open(const char *path, int num_workers);
+  // Return false if workers keep crashing.
+  bool Run();
+  void PrintSummary() const;
+
+private:
+  struct Worker {
+    pid_t pid;
+    // -1 until it says hello.
+    int fd;
+    std::string buffer;
+    bool has_task;
+    long long begin, end;
+  };
+
+  // Return false if "path" has results of other settings or is broken.
+  bool LoadResults(const char *path, const std::string &header);
+  void QueueTasks();
+  bool StartWorker(int slot);
+  void Accept();
+  // Connect workers which have said hello to their slots.
+  void Identify();
+  // Return false if the worker is disconnected.
+  bool HandleLines(int slot);
+  void Collect(int slot);
+  // Give the rest of the task of a stopped worker to others.
+  void Requeue(int slot);
+  void Record(const Result &result);
+
+  const Corpus &corpus_;
+  const char *solver_name_;
+  long long chunk_;
+  std::string socket_path_;
+  int listener_;
+  FILE *output_;
+  Ring *rings_;
+  std::vector<Worker> workers_;
+  // Connections which haven't said hello, and lines received from them.
+  std::vector<std::pair<int, std::string> > connections_;
+  std::vector<bool> is_solved_;
+  std::deque<std::pair<long long, long long> > tasks_;
+  long long num_solved_;
+  double sum_quality_;
+  double sum_time_;
+};
+
+bool Driver::Open(const char *path, int num_workers) {
+  // Resume after the results in the file.
+  std::string header = "# solver " + std::string(solver_name_) +
+                       " boards " + std::to_string(corpus_.size()) +
+                       " corpus " + corpus_.source();
+  if (!LoadResults(path, header))
+    return false;
+  output_ = fopen(path, "a");
+  if (!output_) {
+    fprintf(stderr, "ERROR: Can't open %s\n", path);
+    return false;
+  }
+  fseek(output_, 0, SEEK_END);
+  if (ftell(output_) == 0)
+    fprintf(output_, "%s\n", header.c_str());
+  QueueTasks();
+
+  // Listen to workers.
+  socket_path_ = std::string(path) + ".sock";
+  unlink(socket_path_.c_str());
+  listener_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path_.c_str(),
+          sizeof(address.sun_path) - 1);
+  if (listener_ < 0 ||
+      bind(listener_, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(listener_, num_workers) < 0) {
+    fprintf(stderr, "ERROR: Can't listen to %s\n", socket_path_.c_str());
+    return false;
+  }
+  memcpy(stopped_socket_path, address.sun_path, sizeof(stopped_socket_path));
+  for (int signal_number : kStopSignals)
+    signal(signal_number, RemoveSocket);
+
+  // Share ring buffers with workers.
+  void *memory = mmap(NULL, sizeof(Ring) * num_workers,
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                      -1, 0);
+  if (memory == MAP_FAILED) {
+    fprintf(stderr, "ERROR: Can't share memory with workers.\n");
+    return false;
+  }
+  rings_ = static_cast<Ring *>(memory);
+  workers_.resize(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    new (&rings_[i].head) std::atomic<unsigned long long>(0);
+    new (&rings_[i].tail) std::atomic<unsigned long long>(0);
+    workers_[i].pid = -1;
+    workers_[i].fd = -1;
+    workers_[i].has_task = false;
+  }
+  return true;
+}
+
+bool Driver::Run() {
+  for (int i = 0; i < static_cast<int>(workers_.size()); ++i) {
+    if (!StartWorker(i))
+      return false;
+  }
+
+  int num_restarts = 0;
+  int num_running = static_cast<int>(workers_.size());
+  while (0 < num_running) {
+    // Wait for lines from workers.
+    std::vector<pollfd> fds(1);
+    fds[0].fd = listener_;
+    fds[0].events = POLLIN;
+    for (int i = 0; i < static_cast<int>(connections_.size()); ++i) {
+      pollfd fd = {connections_[i].first, POLLIN, 0};
+      fds.push_back(fd);
+    }
+    for (int i = 0; i < static_cast<int>(workers_.size()); ++i) {
+      pollfd fd = {workers_[i].fd, POLLIN, 0};
+      fds.push_back(fd);
+    }
+    poll(fds.data(), fds.size(), kPollInterval);
+    if (fds[0].revents & POLLIN)
+      Accept();
+    Identify();
+
+    for (int i = 0; i < static_cast<int>(workers_.size()); ++i) {
+      Worker &worker = workers_[i];
+      Collect(i);
+      if (worker.pid < 0)
+        continue;
+      int status = 0;
+      bool is_alive = waitpid(worker.pid, &status, WNOHANG) == 0;
+      if (is_alive && 0 <= worker.fd && !HandleLines(i)) {
+        // A worker which has quit closes the socket just before exiting.
+        if (worker.has_task)
+          kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, &status, 0);
+        is_alive = false;
+      }
+      if (is_alive)
+        continue;
+
+      // Restart a stopped worker if boards are left, counting crashes only.
+      Collect(i);
+      bool has_task = worker.has_task;
+      bool has_crashed = WIFSIGNALED(status) ||
+                         (WIFEXITED(status) && WEXITSTATUS(status) != 0);
+      Requeue(i);
+      if (0 <= worker.fd)
+        close(worker.fd);
+      worker.fd = -1;
+      worker.pid = -1;
+      --num_running;
+      if (has_task || !tasks_.empty()) {
+        if ((has_crashed && kMaxRestarts <= num_restarts++) ||
+            !StartWorker(i)) {
+          return false;
+        }
+        ++num_running;
+      }
+    }
+    fflush(output_);
+  }
+  return true;
+}
+
+void Driver::PrintSummary() const {
+  long long num_boards = corpus_.size();
+  printf("%lld/%lld boards solved", num_solved_, num_boards);
+  if (0 < num_solved_) {
+    printf(", combos %.1f%%, time %.2f ms", 100.0 * sum_quality_ / num_solved_,
+           sum_time_ / num_solved_ / 1000.0);
+  }
+  printf("\n");
+}
+
+bool Driver::LoadResults(const char *path, const std::string &header) {
+  is_solved_.assign(corpus_.size(), false);
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return true;  // A new run.
+
+  // Only a line torn by a crash at the end is cut, since results are
+  // appended in the order finished.
+  long valid_size = 0;
+  bool has_header = false;
+  char line[256];
+  for (int line_number = 1; fgets(line, sizeof(line), file); ++line_number) {
+    bool is_complete = strchr(line, '\n') != NULL;
+    if (!is_complete && feof(file))
+      break;
+    if (!has_header) {
+      // Results must be of the same solver and corpus.
+      if (!is_complete || header + "\n" != line) {
+        fprintf(stderr, "ERROR: %s is not an output of \"%s\".\n",
+                path, header.c_str());
+        fclose(file);
+        return false;
+      }
+      has_header = true;
+      valid_size = ftell(file);
+      continue;
+    }
+
+    Result result = {0};
+    if (!is_complete ||
+        sscanf(line, "%lld %d %d %d %lld %u", &result.index,
+               &result.combos, &result.max_combos, &result.length,
+               &result.num_nodes, &result.think_time) != 6 ||
+        result.index < 0 || corpus_.size() <= result.index) {
+      fprintf(stderr, "ERROR: Line %d of %s is not a result of the corpus.\n",
+              line_number, path);
+      fclose(file);
+      return false;
+    }
+    valid_size = ftell(file);
+    if (!is_solved_[result.index]) {
+      is_solved_[result.index] = true;
+      ++num_solved_;
+      if (0 < result.max_combos)
+        sum_quality_ += static_cast<double>(result.combos) / result.max_combos;
+      sum_time_ += result.think_time;
+    }
+  }
+  fclose(file);
+  if (truncate(path, valid_size) != 0) {
+    fprintf(stderr, "ERROR: Can't cut a torn line of %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+void Driver::QueueTasks() {
+  // Split boards not solved yet into chunks.
+  for (long long i = 0; i < corpus_.size();) {
+    if (is_solved_[i]) {
+      ++i;
+      continue;
+    }
+    long long begin = i;
+    while (i < corpus_.size() && !is_solved_[i] && i - begin < chunk_)
+      ++i;
+    tasks_.push_back(std::make_pair(begin, i));
+  }
+}
+
+bool Driver::StartWorker(int slot) {
+  fflush(stdout);
+  fflush(output_);
+  pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {
+    // Only the driver removes the socket.
+    for (int signal_number : kStopSignals)
+      signal(signal_number, SIG_DFL);
+
+    // Sockets of other workers must be closed when they stop.
+    close(listener_);
+    for (int i = 0; i < static_cast<int>(workers_.size()); ++i) {
+      if (0 <= workers_[i].fd)
+        close(workers_[i].fd);
+    }
+    for (int i = 0; i < static_cast<int>(connections_.size()); ++i)
+      close(connections_[i].first);
+    _exit(RunWorker(socket_path_.c_str(), slot, &rings_[slot], corpus_,
+                    solver_name_));
+  }
+  workers_[slot].pid = pid;
+  return true;
+}
+
+void Driver::Accept() {
+  int fd = accept(listener_, NULL, NULL);
+  if (0 <= fd)
+    connections_.push_back(std::make_pair(fd, std::string()));
+}
+
+void Driver::Identify() {
+  for (int i = 0; i < static_cast<int>(connections_.size());) {
+    int fd = connections_[i].first;
+    std::string &buffer = connections_[i].second;
+    std::string line;
+    pollfd readable = {fd, POLLIN, 0};
+    bool is_closed = poll(&readable, 1, 0) == 1 && !Receive(fd, &buffer);
+    if (!is_closed && !TakeLine(&buffer, &line)) {
+      ++i;
+      continue;
+    }
+    int slot = -1;
+    if (!is_closed && sscanf(line.c_str(), "HELLO %d", &slot) == 1 &&
+        0 <= slot && slot < static_cast<int>(workers_.size()) &&
+        workers_[slot].fd < 0) {
+      workers_[slot].fd = fd;
+      workers_[slot].buffer = buffer;
+    } else {
+      close(fd);
+    }
+    connections_.erase(connections_.begin() + i);
+  }
+}
+
+bool Driver::HandleLines(int slot) {
+  Worker &worker = workers_[slot];
+  pollfd readable = {worker.fd, POLLIN, 0};
+  if (poll(&readable, 1, 0) == 1 && !Receive(worker.fd, &worker.buffer))
+    return false;
+
+  std::string line;
+  while (TakeLine(&worker.buffer, &line)) {
+    if (line != "READY")
+      return false;
+
+    // The last task has been finished.
+    Collect(slot);
+    Requeue(slot);
+
+    // Give the next task.
+    if (tasks_.empty())
+      return SendLine(worker.fd, "QUIT");
+    std::pair<long long, long long> task = tasks_.front();
+    tasks_.pop_front();
+    worker.has_task = true;
+    worker.begin = task.first;
+    worker.end = task.second;
+    if (!SendLine(worker.fd, "TASK " + std::to_string(task.first) + " " +
+                             std::to_string(task.second))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Driver::Collect(int slot) {
+  std::vector<Result> results;
+  Pop(&rings_[slot], &results);
+  for (int i = 0; i < static_cast<int>(results.size()); ++i)
+    Record(results[i]);
+}
+
+void Driver::Requeue(int slot) {
+  Worker &worker = workers_[slot];
+  if (!worker.has_task)
+    return;
+  worker.has_task = false;
+  for (long long i = worker.begin; i < worker.end; ++i) {
+    if (is_solved_[i])
+      continue;
+    long long begin = i;
+    while (i < worker.end && !is_solved_[i])
+      ++i;
+    tasks_.push_front(std::make_pair(begin, i));
+  }
+}
+
+void Driver::Record(const Result &result) {
+  if (result.index < 0 || corpus_.size() <= result.index ||
+      is_solved_[result.index]) {
+    return;
+  }
+  is_solved_[result.index] = true;
+  ++num_solved_;
+  if (0 < result.max_combos)
+    sum_quality_ += static_cast<double>(result.combos) / result.max_combos;
+  sum_time_ += result.think_time;
+  fprintf(output_, "%lld %d %d %d %lld %u\n", result.index, result.combos,
+          result.max_combos, result.length, result.num_nodes,
+          result.think_time);
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int num_workers = static_cast<int>(std::thread::hardware_concurrency());
+  const char *solver_name = "dfs";
+  long long num_boards = 1000;
+  const char *trace_path = NULL;
+  long long chunk = 64;
+  const char *path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+      num_workers = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc) {
+      solver_name = argv[++i];
+    } else if (strcmp(argv[i], "--boards") == 0 && i + 1 < argc) {
+      num_boards = atoll(argv[++i]);
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace_path = argv[++i];
+    } else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+      chunk = atoll(argv[++i]);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      path = NULL;
+      break;
+    }
+  }
+  if (!path) {
+    fprintf(stderr, "Usage: %s [--workers N] [--solver NAME] [--boards N] "
+            "[--trace FILE] [--chunk N] OUTPUT\n", argv[0]);
+    return 2;
+  }
+  Solver *solver = Solver::Create(solver_name);
+  if (!solver) {
+    fprintf(stderr, "ERROR: Unknown solver %s\n", solver_name);
+    return 2;
+  }
+  delete solver;
+  if (num_workers < 1)
+    num_workers = 1;
+  if (chunk < 1)
+    chunk = 1;
+
+  Corpus corpus;
+  if (trace_path) {
+    if (!corpus.Load(trace_path)) {
+      fprintf(stderr, "ERROR: %s is not a trace or is broken.\n", trace_path);
+      return 2;
+    }
+  } else {
+    corpus.CreateFromSeeds(num_boards);
+  }
+
+  // Workers notice a stopped driver by errors of the socket.
+  signal(SIGPIPE, SIG_IGN);
+  Driver driver(corpus, solver_name, chunk);
+  if (!driver.Open(path, num_workers))
+    return 2;
+  bool has_finished = driver.Run();
+  driver.PrintSummary();
+  if (!has_finished) {
+    fprintf(stderr, "ERROR: Workers keep stopping. Run again to resume.\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,271 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+// Measure quality and thinking time of solvers under combinations of settings
+// on a fixed set of boards, and print the Pareto frontier of them.
+//
+// Usage: benchmark [--boards N] [--baseline FILE] [--save-baseline FILE]
+//   --boards N            The number of boards (default: 20).
+//   --baseline FILE       Fail if the frontier falls below the one in FILE.
+//   --save-baseline FILE  Save the frontier into FILE.
+//-----------------------------------------------------------------------------
+
+#include <algorithm>  // std::max()
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>  // atoi()
+#include <cstring>  // strcmp()
+#include <string>
+#include <thread>
+#include <vector>
+#include "ai.h"
+#include "board.h"
+#include "lookahead.h"
+#include "mcts.h"
+#include "planner.h"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// Tolerance to compare with a baseline, since time depends on the machine.
+const double kQualityTolerance = 0.03;
+const double kTimeTolerance = 2.0;
+
+struct Result {
+  // A solver and its settings.
+  std::string name;
+  // The average of achieved combos divided by the maximum combos.
+  double quality;
+  double route_length;
+  // The average number of boards searched.
+  double num_nodes;
+  // The average thinking time in milliseconds.
+  double time;
+  bool is_optimal;
+};
+
+std::vector<Board> CreateBoards(int num_boards) {
+  std::vector<Board> boards(num_boards);
+  for (int i = 0; i < num_boards; ++i)
+    boards[i].Initialize(i + 1);
+  return boards;
+}
+
+Result Measure(const std::string &name, const Solver &solver,
+               const std::vector<Board> &boards) {
+  Result result = {name};
+  for (int i = 0; i < static_cast<int>(boards.size()); ++i) {
+    Board board = boards[i];
+    int max_combos = board.CalculateMaxCombos();
+
+    Clock::time_point begin_time = Clock::now();
+    long long num_nodes = 0;
+    Solver::Route route = solver.GetBestRoute(board, &num_nodes);
+    result.time += std::chrono::duration<double, std::milli>(
+        Clock::now() - begin_time).count();
+
+    // Move orbs along the route.
+    int current_position = route.begin_id;
+    int length = 0;
+    for (; length < route.size(); ++length) {
+      int direction = route.directions[length];
+      if (0 == direction)
+        break;
+      board.MoveOrb(direction, current_position);
+      current_position += direction;
+    }
+
+    // Count combos without dropping orbs to exclude luck.
+    Board::Score score = board.VanishOrbs();
+    result.quality += static_cast<double>(score.sum_combos) / max_combos;
+    result.route_length += length;
+    result.num_nodes += num_nodes;
+  }
+  result.quality /= boards.size();
+  result.route_length /= boards.size();
+  result.num_nodes /= boards.size();
+  result.time /= boards.size();
+  return result;
+}
+
+// Whether "a" is at least as good as "b" in both quality and time.
+bool Dominates(double quality_a, double time_a,
+               double quality_b, double time_b) {
+  return quality_b <= quality_a && time_a <= time_b;
+}
+
+void FindFrontier(std::vector<Result> *results) {
+  for (int i = 0; i < static_cast<int>(results->size()); ++i) {
+    Result &a = (*results)[i];
+    a.is_optimal = true;
+    for (int j = 0; j < static_cast<int>(results->size()); ++j) {
+      const Result &b = (*results)[j];
+      if (i != j && Dominates(b.quality, b.time, a.quality, a.time) &&
+          (a.quality < b.quality || b.time < a.time)) {
+        a.is_optimal = false;
+        break;
+      }
+    }
+  }
+}
+
+void PrintResult(const Result &result) {
+  printf("%c %-20s  combos %5.1f%%  length %5.1f  nodes %10.0f  "
+         "time %8.2f ms\n",
+         result.is_optimal ? '*' : ' ', result.name.c_str(),
+         100.0 * result.quality, result.route_length, result.num_nodes,
+         result.time);
+}
+
+bool SaveBaseline(const char *path, const std::vector<Result> &results) {
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return false;
+  // Quality doesn't depend on the machine except under time limits, but time
+  // does.
+  fprintf(file, "# Time is milliseconds per board on the machine which saved "
+          "this file,\n# and is compared with a tolerance of x%.0f. Save it "
+          "again on another machine.\n", kTimeTolerance);
+  fprintf(file, "# name quality time\n");
+  for (int i = 0; i < static_cast<int>(results.size()); ++i) {
+    const Result &r = results[i];
+    if (!r.is_optimal)
+      continue;
+    fprintf(file, "%s %.4f %.3f\n", r.name.c_str(), r.quality, r.time);
+  }
+  fclose(file);
+  return true;
+}
+
+// Return the number of baseline points not covered by "results",
+// or -1 if the baseline can't be read.
+int CompareWithBaseline(const char *path, const std::vector<Result> &results) {
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return -1;
+  int num_regressions = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    Result baseline = {""};
+    char name[128];
+    if (line[0] == '#' ||
+        sscanf(line, "%127s %lf %lf",
+               name, &baseline.quality, &baseline.time) != 3) {
+      continue;
+    }
+    baseline.name = name;
+
+    // Any result must be as good as the point of the baseline.
+    bool is_covered = false;
+    for (int i = 0; i < static_cast<int>(results.size()); ++i) {
+      if (Dominates(results[i].quality + kQualityTolerance,
+                    results[i].time / kTimeTolerance,
+                    baseline.quality, baseline.time)) {
+        is_covered = true;
+        break;
+      }
+    }
+    if (!is_covered) {
+      ++num_regressions;
+      printf("regression: ");
+      PrintResult(baseline);
+    }
+  }
+  fclose(file);
+  return num_regressions;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int num_boards = 20;
+  const char *baseline_path = NULL;
+  const char *saved_baseline_path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--boards") == 0 && i + 1 < argc) {
+      num_boards = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "--save-baseline") == 0 && i + 1 < argc) {
+      saved_baseline_path = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--boards N] [--baseline FILE] "
+              "[--save-baseline FILE]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  // Settings to be compared.
+  const int kDepths[] = {6, 8, 10};
+  const int kStarts[] = {3, 6};
+  const int kTimeLimits[] = {0, 50};
+  const int kIterations[] = {250, 500, 1000};
+  const int kWeights[] = {2, 3, 4};
+  const int kNextTurnWeights[] = {0, 50};
+  std::vector<int> threads(1, 1);
+  int num_cores = static_cast<int>(std::thread::hardware_concurrency());
+  if (1 < num_cores)
+    threads.push_back(num_cores);
+
+  std::vector<Board> boards = CreateBoards(num_boards);
+  std::vector<Result> results;
+  char name[128];
+  for (int depth : kDepths) {
+    for (int starts : kStarts) {
+      for (int num_threads : threads) {
+        for (int time_limit : kTimeLimits) {
+          Ai::Settings settings = {depth, starts, depth - 5, num_threads,
+                                   time_limit};
+          snprintf(name, sizeof(name), "dfs-d%d-s%d-t%d-l%d",
+                   depth, starts, num_threads, time_limit);
+          results.push_back(Measure(name, Ai(settings), boards));
+        }
+      }
+    }
+  }
+  for (int iterations : kIterations) {
+    for (int num_threads : threads) {
+      Mcts::Settings settings = Mcts::kDefaultSettings;
+      settings.num_iterations = iterations;
+      settings.num_threads = num_threads;
+      snprintf(name, sizeof(name), "mcts-i%d-t%d", iterations, num_threads);
+      results.push_back(Measure(name, Mcts(settings), boards));
+    }
+  }
+  for (int weight : kWeights) {
+    Planner::Settings settings = Planner::kDefaultSettings;
+    settings.heuristic_weight = weight;
+    snprintf(name, sizeof(name), "plan-w%d", weight);
+    results.push_back(Measure(name, Planner(settings), boards));
+  }
+  for (int weight : kNextTurnWeights) {
+    Lookahead::Settings settings = Lookahead::kDefaultSettings;
+    settings.next_turn_weight = weight;
+    snprintf(name, sizeof(name), "lookahead-w%d", weight);
+    results.push_back(Measure(name, Lookahead(settings, Ai::kDefaultSettings),
+                              boards));
+  }
+
+  FindFrontier(&results);
+  printf("%d boards (* Pareto optimal)\n", num_boards);
+  for (int i = 0; i < static_cast<int>(results.size()); ++i)
+    PrintResult(results[i]);
+
+  if (saved_baseline_path && !SaveBaseline(saved_baseline_path, results)) {
+    fprintf(stderr, "ERROR: Can't write %s\n", saved_baseline_path);
+    return 2;
+  }
+  if (baseline_path) {
+    int num_regressions = CompareWithBaseline(baseline_path, results);
+    if (num_regressions < 0) {
+      fprintf(stderr, "ERROR: Can't read %s\n", baseline_path);
+      return 2;
+    }
+    if (0 < num_regressions) {
+      printf("FAILED: %d points of the baseline are not reached.\n",
+             num_regressions);
+      return 1;
+    }
+    printf("PASSED: the baseline is reached.\n");
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+// Re-execute turns recorded by "app --trace FILE" without graphics to verify
+// determinism and to measure thinking time again.
+//
+// Usage: replay [--solver NAME] FILE
+//   --solver NAME  The solver to solve turns again (default: the one recorded
+//                  in FILE, or dfs for traces without it).
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>  // srand()
+#include <cstring>  // strcmp()
+#include <string>
+#include <vector>
+#include "board.h"
+#include "solver.h"
+#include "trace.h"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+std::vector<int> GetDirections(Solver::Route route) {
+  std::vector<int> directions;
+  for (int i = 0; i < route.size(); ++i) {
+    int direction = route.directions[i];
+    if (0 == direction)
+      break;
+    directions.push_back(direction);
+  }
+  return directions;
+}
+
+// Same as "Game::VanishOrbs()" without displaying.
+std::vector<trace::Wave> VanishOrbs(Board *board) {
+  std::vector<trace::Wave> waves;
+  Board prev_board;
+  do {
+    prev_board = *board;
+    Board::Score score = board->VanishOrbs();
+    if (0 < score.sum_combos) {
+      trace::Wave wave = {score.sum_orbs, score.sum_combos};
+      waves.push_back(wave);
+    }
+    board->DropOrbs();
+  } while (!board->Equals(prev_board));
+  return waves;
+}
+
+bool EqualsWaves(const std::vector<trace::Wave> &a,
+                 const std::vector<trace::Wave> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (int i = 0; i < static_cast<int>(a.size()); ++i) {
+    if (a[i].sum_orbs != b[i].sum_orbs || a[i].sum_combos != b[i].sum_combos)
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  const char *solver_name = NULL;
+  const char *path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc)
+      solver_name = argv[++i];
+    else
+      path = argv[i];
+  }
+  if (!path) {
+    fprintf(stderr, "Usage: %s [--solver NAME] FILE\n", argv[0]);
+    return 2;
+  }
+  trace::Reader reader;
+  if (!reader.Open(path)) {
+    fprintf(stderr, "ERROR: %s is not a trace.\n", path);
+    return 2;
+  }
+
+  // Routes differ from the recorded ones under another solver.
+  std::string recorded_name = reader.solver_name();
+  if (!solver_name) {
+    solver_name = recorded_name.empty() ? "dfs" : recorded_name.c_str();
+  } else if (!recorded_name.empty() && recorded_name != solver_name) {
+    fprintf(stderr, "WARNING: %s was recorded with %s, not %s. "
+            "Routes may differ.\n", path, recorded_name.c_str(), solver_name);
+  }
+  Solver *solver = Solver::Create(solver_name);
+  if (!solver) {
+    fprintf(stderr, "ERROR: Unknown solver %s\n", solver_name);
+    return 2;
+  }
+
+  trace::Turn turn;
+  int num_turns = 0;
+  int num_different_routes = 0;
+  int num_different_waves = 0;
+  double recorded_time = 0.0, max_recorded_time = 0.0;
+  double replayed_time = 0.0, max_replayed_time = 0.0;
+  for (; reader.Read(&turn); ++num_turns) {
+    Board board;
+    board.Load(turn.orbs);
+
+    // Solve the puzzle again to compare routes and thinking time.
+    if (turn.mode == trace::kModeAi) {
+      Clock::time_point begin_time = Clock::now();
+      Solver::Route route = solver->GetBestRoute(board);
+      double time = std::chrono::duration<double, std::milli>(
+          Clock::now() - begin_time).count();
+      replayed_time += time;
+      if (max_replayed_time < time)
+        max_replayed_time = time;
+      double original_time = turn.think_time / 1000.0;
+      recorded_time += original_time;
+      if (max_recorded_time < original_time)
+        max_recorded_time = original_time;
+
+      if (route.begin_id != turn.begin_id ||
+          GetDirections(route) != turn.directions) {
+        ++num_different_routes;
+        printf("turn %d: the route differs (%.1f ms -> %.1f ms)\n",
+               num_turns, original_time, time);
+      }
+    }
+
+    // Move orbs along the recorded route and vanish them.
+    int current_position = turn.begin_id;
+    for (int i = 0; i < static_cast<int>(turn.directions.size()); ++i) {
+      board.MoveOrb(turn.directions[i], current_position);
+      current_position += turn.directions[i];
+    }
+    srand(turn.seed);
+    if (!EqualsWaves(VanishOrbs(&board), turn.waves)) {
+      ++num_different_waves;
+      printf("turn %d: the waves differ\n", num_turns);
+    }
+  }
+
+  printf("%d turns, %d different routes, %d different waves\n",
+         num_turns, num_different_routes, num_different_waves);
+  printf("thinking time [ms]: recorded total %.1f max %.1f, "
+         "replayed total %.1f max %.1f\n",
+         recorded_time, max_recorded_time, replayed_time, max_replayed_time);
+  delete solver;
+  if (reader.is_broken()) {
+    fprintf(stderr, "ERROR: Turn %d of %s is broken.\n", num_turns, path);
+    return 2;
+  }
+  return (num_different_routes == 0 && num_different_waves == 0) ? 0 : 1;
+}
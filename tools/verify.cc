@@ -0,0 +1,379 @@
+﻿//-----------------------------------------------------------------------------
+// Copyright (c) 2014 Hirotaka Nagashima. All rights reserved.
+//-----------------------------------------------------------------------------
+// Run random and adversarial boards and moves through "Board" and
+// "ReferenceBoard", and stop on the first divergence with a minimized
+// reproducer.
+//
+// Usage: verify [--cases N] [--threads N] [--seed N]
+//   --cases N    The number of cases, or 0 to run until a divergence
+//                (default: 10000000).
+//   --threads N  The number of threads (default: all cores).
+//   --seed N     The seed of the first case (default: 1).
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>  // atoi(), atoll()
+#include <cstring>  // strcmp()
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "reference_board.h"
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// The maximum number of moves in a case.
+const int kMaxMoves = 40;
+// The maximum number of waves checked in a case.
+const int kMaxWaves = Board::kSize;
+// The number of cases taken by a thread at once.
+const long long kCasesPerTask = 1024;
+
+struct Case {
+  // Orbs in order of rows. "kNone" makes a hole dropped first.
+  int orbs[Board::kSize];
+  int begin_id;
+  std::vector<int> directions;
+  // The seed set before dropping orbs.
+  unsigned int seed;
+};
+
+// An arrangement without connected orbs, used for minimizing cases.
+int GetBackground(int y, int x) {
+  return (x + 3 * y) % Board::kNumAttributes;
+}
+
+void CreateOrbs(std::mt19937 *random, Case *c) {
+  std::uniform_int_distribution<int> kind(0, 9);
+  std::uniform_int_distribution<int> attribute(0, Board::kNumAttributes - 1);
+  int *orbs = c->orbs;
+  switch (kind(*random)) {
+  case 0: {
+    // Few attributes make large groups and long cascades.
+    int num_attributes = 1 + (*random)() % 3;
+    for (int i = 0; i < Board::kSize; ++i)
+      orbs[i] = (*random)() % num_attributes;
+    break;
+  }
+  case 1: {
+    // Stripes, checks or a single attribute.
+    int a = attribute(*random);
+    int b = attribute(*random);
+    int pattern = (*random)() % 4;
+    for (int y = 0; y < Board::kHeight; ++y) {
+      for (int x = 0; x < Board::kWidth; ++x) {
+        bool is_a = (pattern == 0) ? y % 2 == 0 :
+                    (pattern == 1) ? x % 2 == 0 :
+                    (pattern == 2) ? (x + y) % 2 == 0 : true;
+        orbs[y * Board::kWidth + x] = is_a ? a : b;
+      }
+    }
+    break;
+  }
+  case 2: {
+    // Put groups of 4 or 5 orbs such as Ls and crosses on a background.
+    for (int y = 0; y < Board::kHeight; ++y) {
+      for (int x = 0; x < Board::kWidth; ++x)
+        orbs[y * Board::kWidth + x] = GetBackground(y, x);
+    }
+    const int kShapes[][5][2] = {
+      {{0, 0}, {0, 1}, {0, 2}, {1, 0}, {2, 0}},  // L.
+      {{0, 2}, {1, 2}, {2, 0}, {2, 1}, {2, 2}},  // L.
+      {{0, 1}, {1, 0}, {1, 1}, {1, 2}, {2, 1}},  // Cross.
+      {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 3}},  // 4 in a row.
+      {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {4, 0}},  // 5 in a column.
+      {{0, 0}, {0, 1}, {0, 2}, {1, 1}, {2, 1}},  // T.
+    };
+    int num_shapes = 1 + (*random)() % 3;
+    for (int i = 0; i < num_shapes; ++i) {
+      const int (*shape)[2] = kShapes[(*random)() % 6];
+      int a = attribute(*random);
+      int top = (*random)() % Board::kHeight;
+      int left = (*random)() % Board::kWidth;
+      for (int j = 0; j < 5; ++j) {
+        int y = top + shape[j][0];
+        int x = left + shape[j][1];
+        if (y < Board::kHeight && x < Board::kWidth)
+          orbs[y * Board::kWidth + x] = a;
+      }
+    }
+    break;
+  }
+  default:
+    for (int i = 0; i < Board::kSize; ++i)
+      orbs[i] = attribute(*random);
+    break;
+  }
+
+  // Make holes sometimes to check dropping orbs.
+  if ((*random)() % 8 == 0) {
+    int num_holes = 1 + (*random)() % Board::kSize;
+    for (int i = 0; i < num_holes; ++i)
+      orbs[(*random)() % Board::kSize] = Board::kNone;
+  }
+}
+
+void CreateCase(unsigned int seed, Case *c) {
+  std::mt19937 random(seed);
+  CreateOrbs(&random, c);
+  c->seed = seed;
+
+  // Walk randomly, going back and forth sometimes.
+  int y = random() % Board::kHeight;
+  int x = random() % Board::kWidth;
+  Board board;
+  c->begin_id = board.GetId(y, x);
+  c->directions.clear();
+  int num_moves = random() % (kMaxMoves + 1);
+  int prev_direction = 0;
+  while (static_cast<int>(c->directions.size()) < num_moves) {
+    int direction = Board::k4Directions[random() % 4];
+    if (random() % 4 == 0 && prev_direction != 0)
+      direction = -prev_direction;
+    int dy = direction / Board::kArrayWidth;
+    int dx = direction - dy * Board::kArrayWidth;
+    if (y + dy < 0 || Board::kHeight <= y + dy ||
+        x + dx < 0 || Board::kWidth <= x + dx) {
+      continue;
+    }
+    y += dy;
+    x += dx;
+    c->directions.push_back(direction);
+    prev_direction = direction;
+  }
+}
+
+bool EqualsScores(const Board::Score &a, const Board::Score &b) {
+  if (a.sum_orbs != b.sum_orbs || a.sum_combos != b.sum_combos ||
+      a.num_groups != b.num_groups) {
+    return false;
+  }
+  for (int i = 0; i < Board::kNumAttributes; ++i) {
+    if (a.num_orbs[i] != b.num_orbs[i] || a.num_combos[i] != b.num_combos[i])
+      return false;
+  }
+  for (int i = 0; i < a.num_groups; ++i) {
+    const Board::Group &g = a.groups[i];
+    const Board::Group &h = b.groups[i];
+    if (g.attribute != h.attribute || g.size != h.size ||
+        g.shape != h.shape || g.cells != h.cells) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Give both boards the same new orbs without "rand()", which is shared by
+// threads.
+void DropOrbs(unsigned int seed, Board *board, ReferenceBoard *reference) {
+  std::mt19937 random(seed);
+  board->DropOrbs(&random);
+  random.seed(seed);
+  reference->DropOrbs(&random);
+}
+
+// Return an empty string if both implementations agree, or where they
+// diverge.
+std::string Check(const Case &c) {
+  Board board;
+  board.Load(c.orbs);
+  ReferenceBoard reference;
+  reference.Load(board);
+  char message[128];
+
+  // Fill holes.
+  unsigned int seed = c.seed;
+  for (int i = 0; i < Board::kSize; ++i) {
+    if (c.orbs[i] == Board::kNone) {
+      DropOrbs(seed++, &board, &reference);
+      if (!reference.Equals(board))
+        return "DropOrbs() of holes";
+      break;
+    }
+  }
+
+  // Evaluate each move as the ai does.
+  int current_position = c.begin_id;
+  for (int i = 0; i <= static_cast<int>(c.directions.size()); ++i) {
+    if (0 < i) {
+      board.MoveOrb(c.directions[i - 1], current_position);
+      reference.MoveOrb(c.directions[i - 1], current_position);
+      current_position += c.directions[i - 1];
+    }
+    int evaluation = board.Evaluate();
+    int reference_evaluation = reference.Evaluate();
+    if (evaluation != reference_evaluation) {
+      snprintf(message, sizeof(message),
+               "Evaluate() after %d moves: %d, expected %d",
+               i, evaluation, reference_evaluation);
+      return message;
+    }
+  }
+
+  // Vanish and drop orbs until nothing is changed.
+  for (int i = 0; i < kMaxWaves; ++i) {
+    Board::Score score = board.VanishOrbs();
+    Board::Score reference_score = reference.VanishOrbs();
+    if (!EqualsScores(score, reference_score)) {
+      snprintf(message, sizeof(message),
+               "score of VanishOrbs() of wave %d: %d combos %d groups, "
+               "expected %d combos %d groups", i, score.sum_combos,
+               score.num_groups, reference_score.sum_combos,
+               reference_score.num_groups);
+      return message;
+    }
+    if (!reference.Equals(board)) {
+      snprintf(message, sizeof(message), "board after VanishOrbs() of wave %d",
+               i);
+      return message;
+    }
+    if (score.sum_combos == 0)
+      break;
+    DropOrbs(seed++, &board, &reference);
+    if (!reference.Equals(board)) {
+      snprintf(message, sizeof(message), "DropOrbs() of wave %d", i);
+      return message;
+    }
+  }
+  return "";
+}
+
+// Shorten the moves and replace orbs with the background while the
+// divergence remains.
+void Minimize(Case *c) {
+  while (!c->directions.empty()) {
+    Case shorter = *c;
+    shorter.directions.pop_back();
+    if (Check(shorter).empty())
+      break;
+    *c = shorter;
+  }
+  bool is_changed = true;
+  while (is_changed) {
+    is_changed = false;
+    for (int y = 0; y < Board::kHeight; ++y) {
+      for (int x = 0; x < Board::kWidth; ++x) {
+        int &orb = c->orbs[y * Board::kWidth + x];
+        if (orb == GetBackground(y, x))
+          continue;
+        int original = orb;
+        orb = GetBackground(y, x);
+        if (Check(*c).empty()) {
+          orb = original;
+        } else {
+          is_changed = true;
+        }
+      }
+    }
+  }
+}
+
+void PrintCase(const Case &c) {
+  const char *const kAttributes = "RGBHLD";
+  for (int y = 0; y < Board::kHeight; ++y) {
+    printf("  ");
+    for (int x = 0; x < Board::kWidth; ++x) {
+      int orb = c.orbs[y * Board::kWidth + x];
+      putchar(orb == Board::kNone ? '.' : kAttributes[orb]);
+    }
+    putchar('\n');
+  }
+  int begin_y = c.begin_id / Board::kArrayWidth - 1;
+  int begin_x = c.begin_id % Board::kArrayWidth - 1;
+  printf("  begin (y, x) = (%d, %d), moves = ", begin_y, begin_x);
+  for (int i = 0; i < static_cast<int>(c.directions.size()); ++i) {
+    int direction = c.directions[i];
+    putchar(direction == -Board::kArrayWidth ? 'U' :
+            direction == -1 ? 'L' : direction == 1 ? 'R' : 'D');
+  }
+  printf("\n  seed = %u\n", c.seed);
+}
+
+struct Shared {
+  long long num_cases;
+  unsigned int first_seed;
+  std::atomic<long long> next_case;
+  std::atomic<long long> num_checked;
+  std::atomic<bool> has_diverged;
+  std::mutex mutex;
+  Case divergence;
+};
+
+void Run(Shared *shared) {
+  Case c;
+  while (!shared->has_diverged) {
+    long long begin = shared->next_case.fetch_add(kCasesPerTask);
+    long long end = begin + kCasesPerTask;
+    if (0 < shared->num_cases) {
+      if (shared->num_cases <= begin)
+        return;
+      if (shared->num_cases < end)
+        end = shared->num_cases;
+    }
+    for (long long i = begin; i < end; ++i) {
+      CreateCase(shared->first_seed + static_cast<unsigned int>(i), &c);
+      if (!Check(c).empty()) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (!shared->has_diverged) {
+          shared->divergence = c;
+          shared->has_diverged = true;
+        }
+        return;
+      }
+    }
+    shared->num_checked += end - begin;
+  }
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Shared shared;
+  shared.num_cases = 10000000;
+  shared.first_seed = 1;
+  shared.next_case = 0;
+  shared.num_checked = 0;
+  shared.has_diverged = false;
+  int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--cases") == 0 && i + 1 < argc) {
+      shared.num_cases = atoll(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      num_threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      shared.first_seed = static_cast<unsigned int>(atoll(argv[++i]));
+    } else {
+      fprintf(stderr, "Usage: %s [--cases N] [--threads N] [--seed N]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (num_threads < 1)
+    num_threads = 1;
+
+  Clock::time_point begin_time = Clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i)
+    threads.push_back(std::thread(Run, &shared));
+  for (int i = 0; i < num_threads; ++i)
+    threads[i].join();
+  double time = std::chrono::duration<double>(Clock::now() - begin_time)
+      .count();
+  long long num_checked = shared.num_checked;
+  printf("%lld cases in %.1f s (%.0f cases/s)\n", num_checked, time,
+         num_checked / (time > 0.0 ? time : 1.0));
+  if (!shared.has_diverged)
+    return 0;
+
+  Case c = shared.divergence;
+  printf("DIVERGED at seed %u: %s\n", c.seed, Check(c).c_str());
+  Minimize(&c);
+  printf("minimized: %s\n", Check(c).c_str());
+  PrintCase(c);
+  return 1;
+}